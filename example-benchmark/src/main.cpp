@@ -0,0 +1,36 @@
+#include "ofMain.h"
+#include "ofApp.h"
+#include "ofAppNoWindow.h"
+
+//========================================================================
+int main(int argc, char* argv[]){
+    //example-benchmark --max-keys 10000000 --tolerance 0.25 --update-baseline --with-gl
+    ofApp* app = new ofApp();
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--with-gl"){
+            app->withGL = true;
+        }
+        else if(arg == "--max-keys" && i+1 < argc){
+            app->maxKeys = ofToInt(argv[++i]);
+        }
+        else if(arg == "--tolerance" && i+1 < argc){
+            app->tolerance = ofToFloat(argv[++i]);
+        }
+        else if(arg == "--baseline" && i+1 < argc){
+            app->baselinePath = argv[++i];
+        }
+        else if(arg == "--update-baseline"){
+            app->updateBaseline = true;
+        }
+    }
+    if(app->withGL){
+        //a real window so drawing the tracks can be timed too
+        ofSetupOpenGL(1024, 768, OF_WINDOW);
+    }
+    else{
+        //no window or GL context, the timeline runs headless
+        ofSetupOpenGL(std::make_shared<ofAppNoWindow>(), 320, 240, OF_WINDOW);
+    }
+    ofRunApp(app);
+}
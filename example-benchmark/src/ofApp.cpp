@@ -0,0 +1,286 @@
+#include "ofApp.h"
+
+//keys are this far apart in every synthetic track
+#define KEY_SPACING_MILLIS 10
+//samples taken by each sampling benchmark
+#define NUM_SAMPLES 1000000
+
+static const char* trackTypes[] = { "Curves", "LFO", "Bangs", "Switches", "Notes", "Colors" };
+static const int numTrackTypes = 6;
+
+//--------------------------------------------------------------
+ofApp::ofApp(){
+    maxKeys = 1000000;
+    tolerance = 0.25;
+    baselinePath = "benchmark_baseline.csv";
+    updateBaseline = false;
+    exitCode = 0;
+    withGL = false;
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+
+    ofSetLogLevel(OF_LOG_WARNING);
+    ofSeedRandom(0);
+
+    timeline.setWorkingFolder("benchmark/");
+    timeline.setHeadless(!withGL);
+    timeline.setup();
+    //saves and undo are measured on their own
+    timeline.setAutosave(false);
+    timeline.enableUndo(false);
+    timeline.setFrameRate(30);
+
+    for(int numKeys = 1000; numKeys <= maxKeys; numKeys *= 10){
+        timeline.setDurationInMillis((unsigned long long)numKeys * KEY_SPACING_MILLIS + 1000);
+        for(int i = 0; i < numTrackTypes; i++){
+            runTrackType(trackTypes[i], numKeys);
+        }
+        runBatchSampling(numKeys);
+    }
+
+    saveResults("benchmark_results.csv");
+    if(updateBaseline){
+        saveResults(baselinePath);
+    }
+    else{
+        exitCode = compareToBaseline() > 0 ? 1 : 0;
+    }
+    ofDirectory::removeDirectory("benchmark/", true);
+    std::exit(exitCode);
+}
+
+//--------------------------------------------------------------
+void ofApp::runTrackType(string type, int numKeys){
+    string prefix = ofToLower(type) + "/" + ofToString(numKeys) + "/";
+    string xmlPath = "benchmark/" + prefix + "keys.xml";
+    ofDirectory::createDirectory("benchmark/" + prefix, true, true);
+    writeTrackXML(type, xmlPath, numKeys);
+
+    ofxTLKeyframes* track = NULL;
+    record(prefix + "load_xml", numKeys, [&](){
+        track = addTrack(type, type + ofToString(numKeys), xmlPath);
+    });
+    unsigned long long duration = timeline.getDurationInMilliseconds();
+
+    bool hasEvents = type == "Bangs" || type == "Switches" || type == "Notes";
+    if(type != "Bangs"){
+        record(prefix + "sample_sequential", NUM_SAMPLES, [&](){
+            for(int i = 0; i < NUM_SAMPLES; i++){
+                sample(type, track, (unsigned long long)i * duration / NUM_SAMPLES);
+            }
+        });
+
+        vector<unsigned long long> randomTimes(NUM_SAMPLES);
+        for(int i = 0; i < NUM_SAMPLES; i++){
+            randomTimes[i] = ofRandom(duration);
+        }
+        record(prefix + "sample_random", NUM_SAMPLES, [&](){
+            for(int i = 0; i < NUM_SAMPLES; i++){
+                sample(type, track, randomTimes[i]);
+            }
+        });
+    }
+
+    if(hasEvents){
+        unsigned long long numEvents = 0;
+        record(prefix + "event_dispatch", numKeys, [&](){
+            unsigned long long next = track->getNextEventTime(0);
+            while(next != ULLONG_MAX && next < duration){
+                numEvents++;
+                next = track->getNextEventTime(next);
+            }
+        });
+    }
+
+    if(withGL){
+        record(prefix + "preview_recompute", 1, [&](){
+            track->setZoomBounds(ofRange(0, 1.0));
+            track->_draw();
+        });
+    }
+
+    track->useBinarySave = false;
+    record(prefix + "save_xml", numKeys, [&](){
+        track->save();
+    });
+    track->useBinarySave = true;
+    record(prefix + "save_binary", numKeys, [&](){
+        track->save();
+    });
+    record(prefix + "load_binary", numKeys, [&](){
+        track->load();
+    });
+
+    record(prefix + "undo_capture", numKeys, [&](){
+        ofxTLUndoDelta* delta = track->beginUndoDelta();
+        track->addKeyframeAtMillis(.5, duration - 1);
+        if(delta != NULL){
+            delta->finish();
+            delete delta;
+        }
+    });
+
+    string clipboard;
+    track->selectAll();
+    record(prefix + "copy", numKeys, [&](){
+        clipboard = track->copyRequest();
+    });
+    timeline.setCurrentTimeMillis(0);
+    record(prefix + "paste", numKeys, [&](){
+        track->pasteSent(clipboard);
+    });
+
+    timeline.removeTrack(track);
+}
+
+//--------------------------------------------------------------
+//every track type sampled side by side at each frame, like playback does
+void ofApp::runBatchSampling(int numKeys){
+    vector<ofxTLKeyframes*> tracks;
+    vector<string> types;
+    for(int i = 0; i < numTrackTypes; i++){
+        string prefix = ofToLower(trackTypes[i]) + "/" + ofToString(numKeys) + "/";
+        if(string(trackTypes[i]) != "Bangs"){
+            tracks.push_back(addTrack(trackTypes[i], string(trackTypes[i]) + "Batch", "benchmark/" + prefix + "keys.xml"));
+            types.push_back(trackTypes[i]);
+        }
+    }
+
+    unsigned long long duration = timeline.getDurationInMilliseconds();
+    int numFrames = NUM_SAMPLES / tracks.size();
+    record("all/" + ofToString(numKeys) + "/sample_batch", numFrames * tracks.size(), [&](){
+        for(int f = 0; f < numFrames; f++){
+            unsigned long long millis = (unsigned long long)f * duration / numFrames;
+            for(int t = 0; t < tracks.size(); t++){
+                sample(types[t], tracks[t], millis);
+            }
+        }
+    });
+
+    ofxTLExporter exporter;
+    exporter.setup(&timeline);
+    record("all/" + ofToString(numKeys) + "/export_binary", (unsigned long long)timeline.getDurationInFrames() * tracks.size(), [&](){
+        exporter.exportBinary("benchmark/export.tlx");
+    });
+
+    for(int t = 0; t < tracks.size(); t++){
+        timeline.removeTrack(tracks[t]);
+    }
+}
+
+//--------------------------------------------------------------
+ofxTLKeyframes* ofApp::addTrack(string type, string name, string xmlPath){
+    if(type == "Curves") return timeline.addCurves(name, xmlPath);
+    if(type == "LFO") return timeline.addLFO(name, xmlPath);
+    if(type == "Bangs") return timeline.addBangs(name, xmlPath);
+    if(type == "Switches") return timeline.addSwitches(name, xmlPath);
+    if(type == "Notes") return timeline.addMIDI(name, xmlPath);
+    return timeline.addColors(name, xmlPath);
+}
+
+//--------------------------------------------------------------
+//keys evenly spaced, with whatever each type needs beyond time and value
+void ofApp::writeTrackXML(string type, string path, int numKeys){
+    ofstream xml(ofToDataPath(path).c_str());
+    char timecode[32];
+    xml << "<keyframes>\n";
+    for(int i = 0; i < numKeys; i++){
+        unsigned long long millis = (unsigned long long)i * KEY_SPACING_MILLIS;
+        ofxTimecode::timecodeForMillis(millis, timecode, sizeof(timecode));
+        xml << "<key><time>" << timecode << "</time><value>" << ofRandomuf() << "</value>";
+        if(type == "Curves"){
+            xml << "<easefunc>" << i % 10 << "</easefunc><easetype>" << i % 3 << "</easetype>";
+        }
+        else if(type == "Switches" || type == "Notes"){
+            ofxTimecode::timecodeForMillis(millis + KEY_SPACING_MILLIS/2, timecode, sizeof(timecode));
+            xml << "<max>" << timecode << "</max>";
+            if(type == "Notes"){
+                xml << "<pitch>" << 40 + i % 40 << "</pitch><velocity>0.8</velocity>";
+            }
+        }
+        else if(type == "Colors"){
+            xml << "<sampleX>" << ofRandomuf() << "</sampleX><sampleY>" << ofRandomuf() << "</sampleY>";
+        }
+        xml << "</key>\n";
+    }
+    xml << "</keyframes>\n";
+}
+
+//--------------------------------------------------------------
+float ofApp::sample(string type, ofxTLKeyframes* track, unsigned long long millis){
+    if(type == "Colors"){
+        return ((ofxTLColorTrack*)track)->getColorAtMillis(millis).r;
+    }
+    if(type == "Switches" || type == "Notes"){
+        return ((ofxTLSwitches*)track)->isOnAtMillis(millis);
+    }
+    return track->getValueAtTimeInMillis(millis);
+}
+
+//--------------------------------------------------------------
+void ofApp::record(string name, unsigned long long operations, std::function<void()> operation){
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    Result result;
+    result.name = name;
+    result.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    result.operations = operations;
+    results.push_back(result);
+    ofLogNotice("benchmark") << name << ": " << result.micros / 1000. << "ms";
+}
+
+//--------------------------------------------------------------
+void ofApp::saveResults(string path){
+    ofstream csv(ofToDataPath(path).c_str());
+    csv << "name,total_micros,operations,nanos_per_operation\n";
+    for(int i = 0; i < results.size(); i++){
+        csv << results[i].name << ","
+            << (unsigned long long)results[i].micros << ","
+            << results[i].operations << ","
+            << results[i].micros * 1000. / MAX(results[i].operations, 1ULL) << "\n";
+    }
+}
+
+//--------------------------------------------------------------
+int ofApp::compareToBaseline(){
+    ofBuffer baseline = ofBufferFromFile(baselinePath);
+    if(baseline.size() == 0){
+        ofLogWarning("benchmark") << "No baseline at " << baselinePath << ", run with --update-baseline to store one";
+        return 0;
+    }
+    map<string, double> baselineNanos;
+    for(auto line : baseline.getLines()){
+        vector<string> fields = ofSplitString(line, ",");
+        if(fields.size() == 4 && fields[0] != "name"){
+            baselineNanos[fields[0]] = ofToDouble(fields[3]);
+        }
+    }
+
+    int regressions = 0;
+    for(int i = 0; i < results.size(); i++){
+        map<string, double>::iterator it = baselineNanos.find(results[i].name);
+        if(it == baselineNanos.end()){
+            continue;
+        }
+        double nanos = results[i].micros * 1000. / MAX(results[i].operations, 1ULL);
+        if(nanos > it->second * (1 + tolerance)){
+            ofLogError("benchmark") << "REGRESSION " << results[i].name << ": "
+                                    << nanos << "ns per operation, baseline " << it->second << "ns";
+            regressions++;
+        }
+    }
+    ofLogWarning("benchmark") << regressions << " regressions against " << baselinePath;
+    return regressions;
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+
+}
+
+//--------------------------------------------------------------
+void ofApp::draw(){
+
+}
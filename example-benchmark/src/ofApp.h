@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxTimeline.h"
+
+//runs the timeline's core operations on synthetic tracks of 1k keys up to maxKeys,
+//writes the timings to data/benchmark_results.csv and compares them to a baseline.
+//drawing is only timed with --with-gl, headless runs have no GL to draw with
+class ofApp : public ofBaseApp{
+
+  public:
+        ofApp();
+        void setup();
+        void update();
+        void draw();
+
+        //1M by default, 10M is there with --max-keys 10000000 but the tracks are
+        //made by loading xml and that takes minutes and several GB at that size
+        int maxKeys;
+        bool withGL;
+        float tolerance; //fraction slower than the baseline that counts as a regression
+        string baselinePath;
+        bool updateBaseline;
+
+  protected:
+        ofxTimeline timeline;
+
+        typedef struct {
+            string name;
+            double micros;
+            unsigned long long operations;
+        } Result;
+        vector<Result> results;
+
+        void runTrackType(string type, int numKeys);
+        void runBatchSampling(int numKeys);
+        ofxTLKeyframes* addTrack(string type, string name, string xmlPath);
+        void writeTrackXML(string type, string path, int numKeys);
+        float sample(string type, ofxTLKeyframes* track, unsigned long long millis);
+        void record(string name, unsigned long long operations, std::function<void()> operation);
+
+        //returns the number of regressions
+        int compareToBaseline();
+        void saveResults(string path);
+        int exitCode;
+};
@@ -0,0 +1,18 @@
+#include "ofMain.h"
+#include "ofApp.h"
+#include "ofAppNoWindow.h"
+
+//========================================================================
+int main(int argc, char* argv[]){
+    //nothing is drawn, the checks run in setup and the exit code says whether they passed
+    ofSetupOpenGL(std::make_shared<ofAppNoWindow>(), 320, 240, OF_WINDOW);
+    //example-driftTest --hours 72
+    ofApp* app = new ofApp();
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--hours" && i+1 < argc){
+            app->simulatedHours = ofToInt(argv[++i]);
+        }
+    }
+    ofRunApp(app);
+}
@@ -0,0 +1,195 @@
+#include "ofApp.h"
+
+//frames near the start and end of the run are all checked as smpte, the rest only every so often
+#define SMPTE_CHECKED_SECONDS 600
+#define SMPTE_STRIDE 101
+//an odd length so loops land all over the update steps
+#define LOOP_MILLIS 10007
+//updates come this far apart, like an app whose frame rate wanders
+#define MIN_STEP_MICROS 1000
+#define MAX_STEP_MICROS 40000
+
+//--------------------------------------------------------------
+ofApp::ofApp(){
+    simulatedHours = 72;
+    failures = 0;
+    nextBang = 0;
+    numBangs = 0;
+    numLoops = 0;
+    lateBangs = 0;
+    maxBangLatenessMillis = 0;
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    testFrameRates();
+    testTimecodeDrift(23.976, false);
+    testTimecodeDrift(24, false);
+    testTimecodeDrift(25, false);
+    testTimecodeDrift(29.97, false);
+    testTimecodeDrift(29.97, true);
+    testTimecodeDrift(30, false);
+    testTimecodeDrift(50, false);
+    testTimecodeDrift(59.94, true);
+    testTimecodeDrift(60, false);
+    testTimecodeDrift(1000, false);
+    testPlaybackDrift();
+
+    ofLogNotice("driftTest") << failures << " failures over " << simulatedHours << " simulated hours";
+    std::exit(failures > 0 ? 1 : 0);
+}
+
+//--------------------------------------------------------------
+//float rates become the exact rational rate they stand for
+void ofApp::testFrameRates(){
+    float rates[] =        { 23.976, 24, 29.97, 30, 47.952, 59.94, 60, 1000, 12.5, 119.88 };
+    int numerators[] =     { 24000,  24, 30000, 30, 48000,  60000, 60, 1000, 12500, 119880 };
+    int denominators[] =   { 1001,   1,  1001,  1,  1001,   1001,  1,  1,    1000, 1000 };
+    for(int i = 0; i < 10; i++){
+        ofxTimecode timecode;
+        timecode.setFPS(rates[i]);
+        check(timecode.getFPSNumerator() == numerators[i] && timecode.getFPSDenominator() == denominators[i],
+              "setFPS(" + ofToString(rates[i]) + ") is " + ofToString(timecode.getFPSNumerator()) + "/" + ofToString(timecode.getFPSDenominator()));
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::testTimecodeDrift(float fps, bool dropFrame){
+    ofxTimecode timecode;
+    timecode.setFPS(fps);
+    timecode.setDropFrame(dropFrame);
+    unsigned long long numerator = timecode.getFPSNumerator();
+    unsigned long long denominator = timecode.getFPSDenominator();
+    string name = ofToString(fps) + (dropFrame ? " drop frame" : "");
+
+    unsigned long long totalMicros = simulatedHours * 60 * 60 * 1000000ULL;
+    int lastFrame = totalMicros * numerator / (1000000ULL * denominator);
+    int smpteCheckedFrames = SMPTE_CHECKED_SECONDS * numerator / denominator;
+
+    int wrongMicros = 0;
+    int wrongMillis = 0;
+    int wrongSmpte = 0;
+    for(int frame = 0; frame <= lastFrame; frame++){
+        //the frame starts at exactly frame/fps seconds, rounded up to the next microsecond
+        unsigned long long exact = (unsigned long long)frame * denominator * 1000000;
+        unsigned long long micros = timecode.microsForFrame(frame);
+        if(micros * numerator < exact || (frame > 0 && (micros - 1) * numerator >= exact) || timecode.frameForMicros(micros) != frame){
+            wrongMicros++;
+        }
+        if(timecode.frameForMillis(timecode.millisForFrame(frame)) != frame){
+            wrongMillis++;
+        }
+        if(frame < smpteCheckedFrames || lastFrame - frame < smpteCheckedFrames || frame % SMPTE_STRIDE == 0){
+            if(timecode.frameForSmpte(timecode.smpteForFrame(frame)) != frame){
+                wrongSmpte++;
+            }
+        }
+    }
+
+    check(wrongMicros == 0, name + " has " + ofToString(wrongMicros) + " frames off their exact start time");
+    check(wrongMillis == 0, name + " has " + ofToString(wrongMillis) + " frames that don't survive a round trip through millis");
+    check(wrongSmpte == 0, name + " has " + ofToString(wrongSmpte) + " frames that don't survive a round trip through smpte");
+    //after the whole run the clock is still on the frame it should be
+    check(timecode.frameForMicros(totalMicros) == lastFrame, name + " is on frame " + ofToString(timecode.frameForMicros(totalMicros)) + " after " + ofToString(simulatedHours) + " hours, expected " + ofToString(lastFrame));
+    ofLogNotice("driftTest") << name << ": " << lastFrame + 1 << " frames checked, ends at " << timecode.smpteForFrame(lastFrame);
+}
+
+//--------------------------------------------------------------
+void ofApp::testPlaybackDrift(){
+    ofSeedRandom(0);
+
+    ofxTLFakeClockTimeline timeline;
+    timeline.setWorkingFolder("driftTest/");
+    timeline.setHeadless(true);
+    timeline.setup();
+    timeline.setAutosave(false);
+    timeline.enableUndo(false);
+    timeline.setLoopType(OF_LOOP_NORMAL);
+    timeline.setDurationInMillis(LOOP_MILLIS);
+
+    //kept more than one update away from the loop point, a key that's passed
+    //in the same update that loops is skipped
+    ofxTLBangs* bangs = timeline.addBangs("bangs");
+    bangTimes.push_back(MAX_STEP_MICROS/1000);
+    bangTimes.push_back(1234);
+    bangTimes.push_back(5000);
+    bangTimes.push_back(LOOP_MILLIS - 2*MAX_STEP_MICROS/1000);
+    for(int i = 0; i < bangTimes.size(); i++){
+        bangs->addKeyframeAtMillis(bangTimes[i]);
+    }
+    ofAddListener(timeline.events().bangFired, this, &ofApp::bangFired);
+    ofAddListener(timeline.events().playbackLooped, this, &ofApp::playbackLooped);
+
+    long long loopMicros = LOOP_MILLIS * 1000LL;
+    long long totalMicros = simulatedHours * 60 * 60 * 1000000LL;
+    long long startMicros = timeline.fakeMicros;
+    long long wrongTimes = 0;
+    long long updates = 0;
+    timeline.play();
+    while(timeline.fakeMicros - startMicros < totalMicros){
+        timeline.advance(ofRandom(MIN_STEP_MICROS, MAX_STEP_MICROS));
+        //the playhead is exactly where the clock says, not a microsecond off
+        if((long long)timeline.getCurrentTimeMicros() != (timeline.fakeMicros - startMicros) % loopMicros){
+            wrongTimes++;
+        }
+        updates++;
+    }
+    long long elapsed = timeline.fakeMicros - startMicros;
+    timeline.stop();
+    ofRemoveListener(timeline.events().bangFired, this, &ofApp::bangFired);
+    ofRemoveListener(timeline.events().playbackLooped, this, &ofApp::playbackLooped);
+
+    int expectedLoops = elapsed / loopMicros;
+    int expectedBangs = expectedLoops * bangTimes.size();
+    for(int i = 0; i < bangTimes.size(); i++){
+        if(bangTimes[i] * 1000 <= elapsed % loopMicros){
+            expectedBangs++;
+        }
+    }
+    check(wrongTimes == 0, ofToString(wrongTimes) + " of " + ofToString(updates) + " updates had the playhead off the clock");
+    check(numLoops == expectedLoops, ofToString(numLoops) + " loops, expected " + ofToString(expectedLoops));
+    check(numBangs == expectedBangs, ofToString(numBangs) + " bangs, expected " + ofToString(expectedBangs));
+    //a bang is never early and never later than the update after its time
+    check(lateBangs == 0, ofToString(lateBangs) + " bangs fired early or more than one update late");
+    ofLogNotice("driftTest") << "playback: " << updates << " updates, " << numLoops << " loops, " << numBangs
+                             << " bangs at most " << maxBangLatenessMillis << "ms late";
+    ofDirectory::removeDirectory("driftTest/", true);
+}
+
+//--------------------------------------------------------------
+void ofApp::bangFired(ofxTLBangEventArgs& args){
+    //keys fire in order, so this is the one that's due
+    long lateness = args.currentMillis - (long)bangTimes[nextBang];
+    if(lateness < 0 || lateness > MAX_STEP_MICROS/1000){
+        lateBangs++;
+    }
+    maxBangLatenessMillis = MAX(maxBangLatenessMillis, lateness);
+    nextBang = (nextBang + 1) % bangTimes.size();
+    numBangs++;
+}
+
+//--------------------------------------------------------------
+void ofApp::playbackLooped(ofxTLPlaybackEventArgs& args){
+    numLoops++;
+}
+
+//--------------------------------------------------------------
+void ofApp::check(bool passed, string what){
+    if(!passed){
+        ofLogError("driftTest") << "FAILED " << what;
+        failures++;
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+
+}
+
+//--------------------------------------------------------------
+void ofApp::draw(){
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxTimeline.h"
+
+//a timeline whose clock only moves when it's told to
+class ofxTLFakeClockTimeline : public ofxTimeline {
+  public:
+        ofxTLFakeClockTimeline() : fakeMicros(0) {};
+        virtual long long getClockMicros(){ return fakeMicros; };
+        void advance(long long micros){
+            fakeMicros += micros;
+            updateTime();
+        }
+        long long fakeMicros;
+};
+
+//simulates simulatedHours of frames at the common frame rates and checks that every
+//conversion still lands on the exact frame at the end, then plays a looping timeline
+//for as long on a jittery fake clock and checks it never drifts. exits non-zero if anything did
+class ofApp : public ofBaseApp{
+
+  public:
+        ofApp();
+        void setup();
+        void update();
+        void draw();
+
+        int simulatedHours;
+
+  protected:
+        void testFrameRates();
+        void testTimecodeDrift(float fps, bool dropFrame);
+        void testPlaybackDrift();
+        void bangFired(ofxTLBangEventArgs& args);
+        void playbackLooped(ofxTLPlaybackEventArgs& args);
+        void check(bool passed, string what);
+        int failures;
+
+        vector<unsigned long long> bangTimes;
+        int nextBang;
+        int numBangs;
+        int numLoops;
+        long lateBangs;
+        long maxBangLatenessMillis;
+};
@@ -54,7 +54,9 @@ ofxMSATimer::ofxMSATimer(){
 
 uint64_t ofxMSATimer::getAppTimeMicros(){
     QueryPerformanceCounter(&stopTime);
-	return ((stopTime.QuadPart - startTime.QuadPart) * 1000000) / ticksPerSecond.QuadPart;
+	LONGLONG ticks = stopTime.QuadPart - startTime.QuadPart;
+	//whole seconds first so the multiply can't overflow on long running apps
+	return (ticks / ticksPerSecond.QuadPart) * 1000000 + ((ticks % ticksPerSecond.QuadPart) * 1000000) / ticksPerSecond.QuadPart;
 }
 
 #elif defined(TARGET_LINUX)
@@ -0,0 +1,205 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLAutosaver.h"
+#include "ofxTLProfiler.h"
+#include <cstdio>
+
+ofxTLSaveJob::ofxTLSaveJob(ofxTLTrack* track)
+:	track(track)
+{
+
+}
+
+ofxTLTrack* ofxTLSaveJob::getTrack(){
+	return track;
+}
+
+bool ofxTLSaveJob::writeFileAtomically(const string& path, const string& contents){
+	string tempPath = path + ".tmp";
+	ofstream out(tempPath.c_str(), ios::out | ios::binary | ios::trunc);
+	if(!out.is_open()){
+		ofLogError("ofxTLSaveJob::writeFileAtomically") << "Couldn't open " << tempPath << " for writing";
+		return false;
+	}
+	out.write(contents.data(), contents.size());
+	out.close();
+	if(out.fail()){
+		ofLogError("ofxTLSaveJob::writeFileAtomically") << "Couldn't write " << tempPath;
+		ofFile::removeFile(tempPath, false);
+		return false;
+	}
+	return replaceFile(tempPath, path);
+}
+
+bool ofxTLSaveJob::replaceFile(const string& tempPath, const string& path){
+	//rename swaps the file in one step on posix, windows won't rename over an existing file
+	if(std::rename(tempPath.c_str(), path.c_str()) != 0 && !ofFile::moveFromTo(tempPath, path, false, true)){
+		ofLogError("ofxTLSaveJob::replaceFile") << "Couldn't move " << tempPath << " to " << path;
+		ofFile::removeFile(tempPath, false);
+		return false;
+	}
+	return true;
+}
+
+ofxTLAutosaver::ofxTLAutosaver()
+:	writing(NULL),
+	flushRequested(false),
+	delayMillis(250),
+	running(false)
+{
+	//the writer thread starts with the first save
+}
+
+ofxTLAutosaver::~ofxTLAutosaver(){
+	flush();
+	stop();
+}
+
+void ofxTLAutosaver::setDelay(int millis){
+	std::unique_lock<std::mutex> guard(lock);
+	delayMillis = MAX(millis, 0);
+}
+
+int ofxTLAutosaver::getDelay(){
+	return delayMillis;
+}
+
+void ofxTLAutosaver::start(){
+	if(running){
+		return;
+	}
+	running = true;
+	writer = std::thread(&ofxTLAutosaver::writerLoop, this);
+}
+
+void ofxTLAutosaver::stop(){
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		running = false;
+	}
+	wake.notify_all();
+	if(writer.joinable()){
+		writer.join();
+	}
+}
+
+void ofxTLAutosaver::queue(ofxTLSaveJob* job){
+	start();
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		map<ofxTLTrack*, PendingSave>::iterator it = pending.find(job->getTrack());
+		if(it != pending.end()){
+			//never written, it's freed with the finished ones
+			finished.push_back(it->second.job);
+		}
+		PendingSave save;
+		save.job = job;
+		save.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMillis);
+		pending[job->getTrack()] = save;
+	}
+	wake.notify_one();
+}
+
+void ofxTLAutosaver::cancel(ofxTLTrack* track){
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		map<ofxTLTrack*, PendingSave>::iterator it = pending.find(track);
+		if(it != pending.end()){
+			finished.push_back(it->second.job);
+			pending.erase(it);
+		}
+		written.wait(guard, [this, track]{ return writing == NULL || writing->getTrack() != track; });
+	}
+	collectFinished();
+}
+
+void ofxTLAutosaver::flush(){
+	if(running){
+		std::unique_lock<std::mutex> guard(lock);
+		flushRequested = true;
+		wake.notify_one();
+		written.wait(guard, [this]{ return pending.empty() && writing == NULL; });
+		flushRequested = false;
+	}
+	collectFinished();
+}
+
+void ofxTLAutosaver::collectFinished(){
+	vector<ofxTLSaveJob*> done;
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		done.swap(finished);
+	}
+	for(int i = 0; i < done.size(); i++){
+		delete done[i];
+	}
+}
+
+bool ofxTLAutosaver::isSaving(){
+	std::unique_lock<std::mutex> guard(lock);
+	return !pending.empty() || writing != NULL;
+}
+
+void ofxTLAutosaver::writerLoop(){
+	std::unique_lock<std::mutex> guard(lock);
+	while(running){
+		if(pending.empty()){
+			wake.wait(guard);
+			continue;
+		}
+
+		map<ofxTLTrack*, PendingSave>::iterator next = pending.begin();
+		for(map<ofxTLTrack*, PendingSave>::iterator it = pending.begin(); it != pending.end(); it++){
+			if(it->second.deadline < next->second.deadline){
+				next = it;
+			}
+		}
+		//wait for the track to go quiet, more changes push the deadline back
+		if(!flushRequested && std::chrono::steady_clock::now() < next->second.deadline){
+			wake.wait_until(guard, next->second.deadline);
+			continue;
+		}
+
+		writing = next->second.job;
+		pending.erase(next);
+		guard.unlock();
+		{
+			OFXTL_PROFILE_SCOPE(writing->getTrack(), OFXTL_PROFILE_SAVE);
+			writing->write();
+		}
+		guard.lock();
+		finished.push_back(writing);
+		writing = NULL;
+		written.notify_all();
+	}
+}
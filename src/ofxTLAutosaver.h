@@ -0,0 +1,108 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class ofxTLTrack;
+
+//a save of one track that's captured on the main thread and written from the autosaver's.
+//whatever it needs from the track has to be copied or held when it's created
+class ofxTLSaveJob {
+  public:
+	ofxTLSaveJob(ofxTLTrack* track);
+	virtual ~ofxTLSaveJob(){};
+
+	//runs on the writer thread, returns false if the file couldn't be written
+	virtual bool write() = 0;
+
+	ofxTLTrack* getTrack();
+
+	//writes to a temporary file next to path and renames it over the old one,
+	//so a crash half way through never leaves a broken file behind
+	static bool writeFileAtomically(const string& path, const string& contents);
+	static bool replaceFile(const string& tempPath, const string& path);
+
+  protected:
+	ofxTLTrack* track;
+};
+
+//writes autosaves on a background thread.
+//saves of the same track that come in within the delay are merged, only the last one is written.
+//jobs are only ever deleted on the thread that queues them, from collectFinished, cancel or flush
+class ofxTLAutosaver {
+  public:
+	ofxTLAutosaver();
+	virtual ~ofxTLAutosaver();
+
+	//how long to wait for more changes before writing, 250ms by default
+	void setDelay(int millis);
+	int getDelay();
+
+	//takes ownership of the job, replacing any save of the same track that hasn't been written yet
+	void queue(ofxTLSaveJob* job);
+	//forgets any pending save of the track, waiting for it if it's being written right now
+	void cancel(ofxTLTrack* track);
+	//writes everything pending without waiting out the delay and returns once it's done
+	void flush();
+	//frees jobs that have been written
+	void collectFinished();
+	//true while anything is waiting or being written
+	bool isSaving();
+
+  protected:
+	void writerLoop();
+	void start();
+	void stop();
+
+	typedef struct {
+		ofxTLSaveJob* job;
+		std::chrono::steady_clock::time_point deadline;
+	} PendingSave;
+
+	map<ofxTLTrack*, PendingSave> pending;
+	vector<ofxTLSaveJob*> finished;
+	ofxTLSaveJob* writing;
+	bool flushRequested;
+	int delayMillis;
+
+	std::thread writer;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable written;
+	bool running;
+};
@@ -34,7 +34,7 @@
 #include "ofxTLBangs.h"
 
 ofxTLBangs::ofxTLBangs(){
-    lastTimelinePoint = 0;
+    lastTimelinePoint = -1;
 	lastBangTime = 0;
 }
 
@@ -112,20 +112,34 @@ ofxTLKeyframe* ofxTLBangs::keyframeAtScreenpoint(ofVec2f p){
     return nullptr;
 }
 
+bool ofxTLBangs::canLoadInBackground(){
+	return typeid(*this) == typeid(ofxTLBangs);
+}
+
+void ofxTLBangs::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
+	//bangs are only a time, but a subclass might still read more in restoreKeyframe
+	if(typeid(*this) != typeid(ofxTLBangs)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
+}
+
 void ofxTLBangs::update(){
 //	if(isPlaying || timeline->getIsPlaying()){
-		long thisTimelinePoint = currentTrackTime();
-		for(int i = 0; i < keyframes.size(); i++){
-			if(timeline->getInOutRangeMillis().contains(keyframes[i]->time) &&
-               lastTimelinePoint <= keyframes[i]->time &&
-               thisTimelinePoint >= keyframes[i]->time &&
+		//a key fires once when the playhead moves past it, even if it lands exactly on an update
+		long long thisTimelinePoint = currentTrackTime();
+		vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+		for(int i = 0; i < keys.size(); i++){
+			if(timeline->getInOutRangeMillis().contains(keys[i]->time) &&
+               lastTimelinePoint < (long long)keys[i]->time &&
+               thisTimelinePoint >= (long long)keys[i]->time &&
                thisTimelinePoint != lastTimelinePoint)
             {
-//				ofLogNotice() << "fired bang with accuracy of " << (keyframes[i]->time - thisTimelinePoint) << endl;
-				bangFired(keyframes[i]);
+//				ofLogNotice() << "fired bang with accuracy of " << (keys[i]->time - thisTimelinePoint) << endl;
+				bangFired(keys[i]);
 				lastBangTime = ofGetElapsedTimef();
             }
 		}
+		endPlaybackRead();
 		lastTimelinePoint = thisTimelinePoint;
 //	}
 }
@@ -140,12 +154,13 @@ void ofxTLBangs::bangFired(ofxTLKeyframe* key){
     args.currentPercent = timeline->getPercentComplete();
     args.currentFrame = timeline->getCurrentFrame();
     args.currentTime = timeline->getCurrentTime();
-    ofNotifyEvent(events().bangFired, args);
+    notify([this, args]() mutable { ofNotifyEvent(events().bangFired, args); });
 }
 
 void ofxTLBangs::playbackStarted(ofxTLPlaybackEventArgs& args){
 	ofxTLTrack::playbackStarted(args);
-	lastTimelinePoint = currentTrackTime();
+	//so a key right at the playhead still fires
+	lastTimelinePoint = (long long)currentTrackTime() - 1;
 }
 
 void ofxTLBangs::playbackEnded(ofxTLPlaybackEventArgs& args){
@@ -153,7 +168,26 @@ void ofxTLBangs::playbackEnded(ofxTLPlaybackEventArgs& args){
 }
 
 void ofxTLBangs::playbackLooped(ofxTLPlaybackEventArgs& args){
-	lastTimelinePoint = 0;
+	lastTimelinePoint = -1;
+}
+
+unsigned long long ofxTLBangs::getNextEventTime(unsigned long long millis){
+	//keyframes are sorted, find the first one after millis
+	vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+	int low = 0;
+	int high = keys.size();
+	while(low < high){
+		int mid = (low + high) / 2;
+		if(keys[mid]->time <= millis){
+			low = mid + 1;
+		}
+		else{
+			high = mid;
+		}
+	}
+	unsigned long long next = low < keys.size() ? keys[low]->time : ULLONG_MAX;
+	endPlaybackRead();
+	return next;
 }
 
 string ofxTLBangs::getTrackType(){
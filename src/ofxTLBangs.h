@@ -49,16 +49,20 @@ class ofxTLBangs : public ofxTLKeyframes {
 	virtual void playbackLooped(ofxTLPlaybackEventArgs& args);
     
     virtual string getTrackType();
+    virtual unsigned long long getNextEventTime(unsigned long long millis);
 
     float   getBang();
     
  protected:
 
     virtual ofxTLKeyframe* keyframeAtScreenpoint(ofVec2f p);
+	virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
+	virtual bool canLoadInBackground();
 //    bool isPlayingBack;
 	virtual void update();
 	
-    long lastTimelinePoint;
+    //signed so -1 can mean before the first key, key times are compared as long long
+    long long lastTimelinePoint;
 	float lastBangTime; //just for display
 	
     virtual void bangFired(ofxTLKeyframe* key);
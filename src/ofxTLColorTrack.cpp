@@ -43,7 +43,8 @@ ofxTLColorTrack::ofxTLColorTrack()
 	setNextAndPreviousOnUpdate(false)
 
 {
-	//
+	//samples are read from the pixels, the texture is only made once the palette is shown
+	colorPallete.setUseTexture(false);
 }
 
 void ofxTLColorTrack::draw(){
@@ -53,6 +54,7 @@ void ofxTLColorTrack::draw(){
 	}
 
 	if(viewIsDirty || shouldRecomputePreviews){
+		OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_PREVIEWS);
 		updatePreviewPalette();
 	}
 
@@ -151,6 +153,10 @@ void ofxTLColorTrack::drawModalContent(){
 		if(colorWindow.getMaxX() > ofGetWidth()){
 			colorWindow.x -= colorWindow.width;
 		}
+		if(!colorPallete.isUsingTexture()){
+			colorPallete.setUseTexture(true);
+			colorPallete.update();
+		}
 		colorPallete.draw(colorWindow);
 
         glm::vec2 selectionPoint = glm::vec2(colorWindow.getMin().x + selectedSample->samplePoint.x*colorWindow.width,colorWindow.getMin().y + selectedSample->samplePoint.y*colorWindow.height);
@@ -214,29 +220,29 @@ ofColor ofxTLColorTrack::getColorAtPosition(float pos){
 }
 
 ofColor ofxTLColorTrack::getColorAtMillis(unsigned long long millis){
-	if(keyframes.size() == 0){
-		return defaultColor;
+	OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_SAMPLE);
+	vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+	ofColor color = defaultColor;
+	if(keys.size() == 0){
+		//nothing to sample
 	}
-
-	if(millis <= keyframes[0]->time){
-		//cout << "getting color before first key " << ((ofxTLColorSample*)keyframes[0])->color << endl;
-		return ((ofxTLColorSample*)keyframes[0])->color;
+	else if(millis <= keys[0]->time){
+		//cout << "getting color before first key " << ((ofxTLColorSample*)keys[0])->color << endl;
+		color = ((ofxTLColorSample*)keys[0])->color;
 	}
-
-	if(millis >= keyframes[keyframes.size()-1]->time){
-		return ((ofxTLColorSample*)keyframes[keyframes.size()-1])->color;
+	else if(millis >= keys[keys.size()-1]->time){
+		color = ((ofxTLColorSample*)keys[keys.size()-1])->color;
 	}
-
-	for(int i = 1; i < keyframes.size(); i++){
-		if(keyframes[i]->time >= millis){
-			ofxTLColorSample* startSample = (ofxTLColorSample*)keyframes[i-1];
-			ofxTLColorSample* endSample = (ofxTLColorSample*)keyframes[i];
-			float interpolationPosition = ofMap(millis, startSample->time, endSample->time, 0.0, 1.0);
-			return samplePaletteAtPosition(startSample->samplePoint.getInterpolated(endSample->samplePoint, interpolationPosition));
-		}
+	else{
+		//keys are sorted, the first one at or after millis ends the pair we're between
+		vector<ofxTLKeyframe*>::iterator next = lower_bound(keys.begin()+1, keys.end(), millis, keyframeIsBeforeTime);
+		ofxTLColorSample* startSample = (ofxTLColorSample*)*(next-1);
+		ofxTLColorSample* endSample = (ofxTLColorSample*)*next;
+		float interpolationPosition = ofMap(millis, startSample->time, endSample->time, 0.0, 1.0);
+		color = samplePaletteAtPosition(startSample->samplePoint.getInterpolated(endSample->samplePoint, interpolationPosition));
 	}
-	ofLogError("ofxTLColorTrack::getColorAtMillis") << "Could not find color for millis " << millis << endl;
-	return defaultColor;
+	endPlaybackRead();
+	return color;
 }
 
 void ofxTLColorTrack::setDefaultColor(ofColor color){
@@ -289,6 +295,7 @@ void ofxTLColorTrack::mouseDragged(ofMouseEventArgs& args, long millis){
 												  ofMap(args.y, colorWindow.getY(), colorWindow.getMaxY(), 0, 1.0-FLT_EPSILON,true));
 			refreshSample(selectedSample);
 			shouldRecomputePreviews = true;
+			markChanged();
 		}
 	}
 	else{
@@ -369,16 +376,27 @@ ofxTLKeyframe* ofxTLColorTrack::newKeyframe(){
 	return sample;
 }
 
-void ofxTLColorTrack::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
+ofxTLKeyframe* ofxTLColorTrack::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLColorSample)){
+		return new ofxTLColorSample(*(ofxTLColorSample*)key);
+	}
+	return NULL;
+}
+
+void ofxTLColorTrack::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
 	ofxTLColorSample* sample = (ofxTLColorSample*)key;
 
-	sample->samplePoint = ofVec2f(xmlStore.getValue("sampleX", 0.0),
-								  xmlStore.getValue("sampleY", 0.0));
+	sample->samplePoint = ofVec2f(keyTags.getValue("sampleX", 0.0),
+								  keyTags.getValue("sampleY", 0.0));
 
 	//for pasted keyframes cancel the color window
 	drawingColorWindow = false;
 	timeline->dismissedModalContent();
 	refreshSample(sample);
+	//subclasses that read their own tags in restoreKeyframe still get them
+	if(typeid(*this) != typeid(ofxTLColorTrack)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
 }
 
 void ofxTLColorTrack::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
@@ -387,6 +405,30 @@ void ofxTLColorTrack::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore
 	xmlStore.setValue("sampleY", sample->samplePoint.y);
 }
 
+bool ofxTLColorTrack::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	if(typeid(*key) != typeid(ofxTLColorSample)){
+		return false;
+	}
+	ofxTLColorSample* sample = (ofxTLColorSample*)key;
+	appendBinary(buffer, sample->samplePoint.x);
+	appendBinary(buffer, sample->samplePoint.y);
+	return true;
+}
+
+void ofxTLColorTrack::restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){
+	ofxTLColorSample* sample = (ofxTLColorSample*)key;
+	readBinary(buffer, sample->samplePoint.x);
+	readBinary(buffer, sample->samplePoint.y);
+	//newKeyframe opens the color window, undo shouldn't
+	drawingColorWindow = false;
+	timeline->dismissedModalContent();
+	refreshSample(sample);
+}
+
+bool ofxTLColorTrack::canRenderInParallel(){
+	return typeid(*this) == typeid(ofxTLColorTrack);
+}
+
 void ofxTLColorTrack::regionSelected(ofLongRange timeRange, ofRange valueRange){
     for(int i = 0; i < keyframes.size(); i++){
     	if(timeRange.contains( keyframes[i]->time )){
@@ -441,6 +483,7 @@ void ofxTLColorTrack::refreshAllSamples(){
 		refreshSample((ofxTLColorSample*)keyframes[i]);
 	}
 	shouldRecomputePreviews = true;
+	markChanged();
 }
 
 void ofxTLColorTrack::refreshSample(ofxTLColorSample* sample){
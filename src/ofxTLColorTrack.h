@@ -77,6 +77,7 @@ class ofxTLColorTrack : public ofxTLKeyframes {
 	
 	virtual void updatePreviewPalette();
 	virtual ofxTLKeyframe* newKeyframe();
+	virtual ofxTLKeyframe* copyKeyframe(ofxTLKeyframe* key);
     virtual ofxTLKeyframe* keyframeAtScreenpoint(ofVec2f p);
 	
 	ofColor colorAtClickTime;
@@ -88,8 +89,11 @@ class ofxTLColorTrack : public ofxTLKeyframes {
 	ofRectangle previousColorRect;
 	ofRectangle newColorRect;
 	
-    virtual void restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+    virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
 	virtual void storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+	virtual bool storeKeyframeBinary(ofxTLKeyframe* key, string& buffer);
+	virtual void restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer);
+	virtual bool canRenderInParallel();
     virtual void selectedKeySecondaryClick(ofMouseEventArgs& args);
 	
 	void refreshAllSamples();
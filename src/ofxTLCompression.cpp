@@ -0,0 +1,132 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLCompression.h"
+
+//the stream starts with the original size, then a series of runs.
+//a control byte below 128 is followed by control+1 literal bytes,
+//otherwise it's a match of (control & 127)+MIN_MATCH bytes at a two byte offset back
+#define MIN_MATCH 4
+#define MAX_MATCH (127 + MIN_MATCH)
+#define MAX_LITERALS 128
+#define MAX_OFFSET 65535
+#define HASH_BITS 14
+
+static unsigned int hashBytes(const unsigned char* p){
+	unsigned int v;
+	memcpy(&v, p, sizeof(v));
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void flushLiterals(const unsigned char* in, size_t start, size_t end, string& out){
+	while(start < end){
+		size_t count = MIN(end - start, (size_t)MAX_LITERALS);
+		out.push_back((char)(count - 1));
+		out.append((const char*)in + start, count);
+		start += count;
+	}
+}
+
+string ofxTLCompression::compress(const string& data){
+	string out;
+	unsigned int size = data.size();
+	out.append((const char*)&size, sizeof(size));
+	out.reserve(data.size() / 2 + sizeof(size));
+
+	const unsigned char* in = (const unsigned char*)data.data();
+	vector<int> table(1 << HASH_BITS, -1);
+	size_t literalStart = 0;
+	size_t i = 0;
+	while(i + MIN_MATCH <= data.size()){
+		unsigned int h = hashBytes(in + i);
+		int candidate = table[h];
+		table[h] = i;
+		if(candidate >= 0 && i - candidate <= MAX_OFFSET && memcmp(in + candidate, in + i, MIN_MATCH) == 0){
+			size_t length = MIN_MATCH;
+			while(length < MAX_MATCH && i + length < data.size() && in[candidate + length] == in[i + length]){
+				length++;
+			}
+			flushLiterals(in, literalStart, i, out);
+			unsigned short offset = i - candidate;
+			out.push_back((char)(128 | (length - MIN_MATCH)));
+			out.append((const char*)&offset, sizeof(offset));
+			i += length;
+			literalStart = i;
+		}
+		else{
+			i++;
+		}
+	}
+	flushLiterals(in, literalStart, data.size(), out);
+	return out;
+}
+
+bool ofxTLCompression::decompress(const string& data, string& out){
+	unsigned int size;
+	if(data.size() < sizeof(size)){
+		return false;
+	}
+	memcpy(&size, data.data(), sizeof(size));
+	out.clear();
+	out.reserve(size);
+
+	size_t i = sizeof(size);
+	while(i < data.size()){
+		unsigned char control = data[i++];
+		if(control < 128){
+			size_t count = control + 1;
+			if(i + count > data.size()){
+				return false;
+			}
+			out.append(data, i, count);
+			i += count;
+		}
+		else{
+			unsigned short offset;
+			if(i + sizeof(offset) > data.size()){
+				return false;
+			}
+			memcpy(&offset, data.data() + i, sizeof(offset));
+			i += sizeof(offset);
+			size_t length = (control & 127) + MIN_MATCH;
+			if(offset == 0 || offset > out.size()){
+				return false;
+			}
+			//matches can overlap what they're writing so copy a byte at a time
+			size_t from = out.size() - offset;
+			for(size_t b = 0; b < length; b++){
+				out.push_back(out[from + b]);
+			}
+		}
+	}
+	return out.size() == size;
+}
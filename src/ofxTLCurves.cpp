@@ -58,6 +58,25 @@ ofxTLKeyframe* ofxTLCurves::newKeyframe(){
 	return k;
 }
 
+ofxTLKeyframe* ofxTLCurves::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLTweenKeyframe)){
+		return new ofxTLTweenKeyframe(*(ofxTLTweenKeyframe*)key);
+	}
+	return NULL;
+}
+
+bool ofxTLCurves::canMapBinaryFile(){
+	return typeid(*this) == typeid(ofxTLCurves);
+}
+
+bool ofxTLCurves::canLoadInBackground(){
+	return typeid(*this) == typeid(ofxTLCurves);
+}
+
+bool ofxTLCurves::canRenderInParallel(){
+	return typeid(*this) == typeid(ofxTLCurves);
+}
+
 void ofxTLCurves::drawModalContent(){
 
 	//****** DRAW EASING CONTROLS
@@ -238,10 +257,14 @@ void ofxTLCurves::selectedKeySecondaryClick(ofMouseEventArgs& args){
     timeline->presentedModalContent(this);
 }
 
-void ofxTLCurves::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
+void ofxTLCurves::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
     ofxTLTweenKeyframe* tweenKey =  (ofxTLTweenKeyframe*)key;
-    tweenKey->easeFunc = easingFunctions[ofClamp(xmlStore.getValue("easefunc", 0), 0, easingFunctions.size()-1)];
-    tweenKey->easeType = easingTypes[ofClamp(xmlStore.getValue("easetype", 0), 0, easingTypes.size()-1)];
+    tweenKey->easeFunc = easingFunctions[ofClamp(keyTags.getValue("easefunc", 0), 0, easingFunctions.size()-1)];
+    tweenKey->easeType = easingTypes[ofClamp(keyTags.getValue("easetype", 0), 0, easingTypes.size()-1)];
+	//subclasses that read their own tags in restoreKeyframe still get them
+	if(typeid(*this) != typeid(ofxTLCurves)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
 }
 
 void ofxTLCurves::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
@@ -250,6 +273,25 @@ void ofxTLCurves::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
     xmlStore.addValue("easetype", tweenKey->easeType->id);
 }
 
+bool ofxTLCurves::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	if(typeid(*key) != typeid(ofxTLTweenKeyframe)){
+		return false;
+	}
+    ofxTLTweenKeyframe* tweenKey =  (ofxTLTweenKeyframe*)key;
+    appendBinary(buffer, tweenKey->easeFunc->id);
+    appendBinary(buffer, tweenKey->easeType->id);
+	return true;
+}
+
+void ofxTLCurves::restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){
+    ofxTLTweenKeyframe* tweenKey =  (ofxTLTweenKeyframe*)key;
+    int easeFunc, easeType;
+    readBinary(buffer, easeFunc);
+    readBinary(buffer, easeType);
+    tweenKey->easeFunc = easingFunctions[ofClamp(easeFunc, 0, easingFunctions.size()-1)];
+    tweenKey->easeType = easingTypes[ofClamp(easeType, 0, easingTypes.size()-1)];
+}
+
 void ofxTLCurves::initializeEasings(){
 
 	//FUNCTIONS ----
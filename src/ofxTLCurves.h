@@ -110,8 +110,14 @@ class ofxTLCurves : public ofxTLKeyframes {
   protected:
 
     virtual ofxTLKeyframe* newKeyframe();
-    virtual void restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+    virtual ofxTLKeyframe* copyKeyframe(ofxTLKeyframe* key);
+    virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
 	virtual void storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+	virtual bool storeKeyframeBinary(ofxTLKeyframe* key, string& buffer);
+	virtual void restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer);
+	virtual bool canMapBinaryFile();
+	virtual bool canLoadInBackground();
+	virtual bool canRenderInParallel();
 
     virtual void selectedKeySecondaryClick(ofMouseEventArgs& args);
 	virtual float interpolateValueForKeys(ofxTLKeyframe* start,ofxTLKeyframe* end, unsigned long long sampleTime);
@@ -150,11 +150,22 @@ ofxTLKeyframe* ofxTLEmptyKeyframes::newKeyframe(){
 	return newKey;
 }
 
-void ofxTLEmptyKeyframes::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
+ofxTLKeyframe* ofxTLEmptyKeyframes::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLEmptyKeyframe)){
+		return new ofxTLEmptyKeyframe(*(ofxTLEmptyKeyframe*)key);
+	}
+	return NULL;
+}
+
+void ofxTLEmptyKeyframes::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
 	ofxTLEmptyKeyframe* emptyKey = (ofxTLEmptyKeyframe*)key;
-	emptyKey->color = ofColor(xmlStore.getValue("r", 255),
-							  xmlStore.getValue("g", 255),
-							  xmlStore.getValue("b", 255));
+	emptyKey->color = ofColor(keyTags.getValue("r", 255),
+							  keyTags.getValue("g", 255),
+							  keyTags.getValue("b", 255));
+	//subclasses that read their own tags in restoreKeyframe still get them
+	if(typeid(*this) != typeid(ofxTLEmptyKeyframes)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
 }
 
 void ofxTLEmptyKeyframes::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
@@ -164,6 +175,24 @@ void ofxTLEmptyKeyframes::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlS
 	xmlStore.addValue("b",emptyKey->color.b);
 }
 
+bool ofxTLEmptyKeyframes::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	if(typeid(*key) != typeid(ofxTLEmptyKeyframe)){
+		return false;
+	}
+	ofxTLEmptyKeyframe* emptyKey = (ofxTLEmptyKeyframe*)key;
+	appendBinary(buffer, emptyKey->color.r);
+	appendBinary(buffer, emptyKey->color.g);
+	appendBinary(buffer, emptyKey->color.b);
+	return true;
+}
+
+void ofxTLEmptyKeyframes::restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){
+	ofxTLEmptyKeyframe* emptyKey = (ofxTLEmptyKeyframe*)key;
+	readBinary(buffer, emptyKey->color.r);
+	readBinary(buffer, emptyKey->color.g);
+	readBinary(buffer, emptyKey->color.b);
+}
+
 ofxTLKeyframe* ofxTLEmptyKeyframes::keyframeAtScreenpoint(ofVec2f p){
 	return ofxTLKeyframes::keyframeAtScreenpoint(p);
 }
@@ -84,11 +84,14 @@ class ofxTLEmptyKeyframes : public ofxTLKeyframes {
 	//always return the type for your track, in our case ofxTLEmptyKeyframe;
 	//this will enusre that all keyframe objects passed to this class are of this type
 	virtual ofxTLKeyframe* newKeyframe();
+	virtual ofxTLKeyframe* copyKeyframe(ofxTLKeyframe* key);
 	//load this keyframe out of xml, which is alraedy pushed to the right level
 	//only need to save custom properties that our subclass adds
-	virtual void restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+	virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
 	//save custom properties into the xml
     virtual void storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+    virtual bool storeKeyframeBinary(ofxTLKeyframe* key, string& buffer);
+    virtual void restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer);
 
 	//return keyframe at this mouse point if you have non circular keyframes
 	virtual ofxTLKeyframe* keyframeAtScreenpoint(ofVec2f p);
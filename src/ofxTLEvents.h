@@ -94,6 +94,14 @@ class ofxTLSwitchEventArgs : public ofEventArgs {
 	bool on;
 };
 
+class ofxTLLoadEventArgs : public ofEventArgs {
+  public:
+    ofxTimeline* sender;
+	int tracksLoaded;
+	int totalTracks;
+	float progress; //0 to 1
+};
+
 class ofxTLEvents {
   public:
 	ofEvent<ofxTLPlaybackEventArgs> playbackStarted;
@@ -118,6 +126,10 @@ class ofxTLEvents {
 		
 	ofEvent<ofEventArgs> viewWasResized;
 
+	//loadTracksFromFolderAsync, both come from update() on the main thread
+	ofEvent<ofxTLLoadEventArgs> loadProgressed;
+	ofEvent<ofxTLLoadEventArgs> loadFinished;
+
 
     template<class ListenerClass>
     void registerPlaybackEvents(ListenerClass * listener){
@@ -0,0 +1,350 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLExporter.h"
+#include "ofxTimeline.h"
+#include "ofxTLMappedFile.h"
+#include "ofxTLSerialization.h"
+
+#define OFXTL_EXPORT_MAGIC "ofTX"
+#define OFXTL_EXPORT_VERSION 1
+#define OFXTL_EXPORT_BYTE_ORDER 0x01020304
+#define OFXTL_EXPORT_ALIGNMENT 8
+
+static void padToAlignment(string& buffer){
+	buffer.append((OFXTL_EXPORT_ALIGNMENT - buffer.size() % OFXTL_EXPORT_ALIGNMENT) % OFXTL_EXPORT_ALIGNMENT, '\0');
+}
+
+ofxTLExporter::ofxTLExporter()
+:	timeline(NULL),
+	useOwnFrameRate(false)
+{
+	//
+}
+
+ofxTLExporter::~ofxTLExporter(){
+
+}
+
+void ofxTLExporter::setup(ofxTimeline* newTimeline){
+	timeline = newTimeline;
+	if(!workerPool.isSetup()){
+		workerPool.setup();
+	}
+}
+
+void ofxTLExporter::setSampleRate(int fpsNumerator, int fpsDenominator){
+	timecode.setFPS(fpsNumerator, fpsDenominator);
+	useOwnFrameRate = true;
+}
+
+void ofxTLExporter::useTimelineFrameRate(){
+	useOwnFrameRate = false;
+}
+
+void ofxTLExporter::setNumThreads(int numThreads){
+	workerPool.setup(numThreads);
+}
+
+size_t ofxTLExporter::getColumnSize(ofxTLExportColumnType type, unsigned int numFrames){
+	return (size_t)numFrames * (type == OFXTL_EXPORT_RGB ? 3 : sizeof(float));
+}
+
+void ofxTLExporter::collectColumns(vector<ofxTLExportColumn>& columns){
+	vector<ofxTLPage*>& pages = timeline->getPages();
+	for(int i = 0; i < pages.size(); i++){
+		vector<ofxTLTrack*>& tracks = pages[i]->getTracks();
+		for(int t = 0; t < tracks.size(); t++){
+			ofxTLExportColumn column;
+			column.name = tracks[t]->getName();
+			column.track = tracks[t];
+			column.offset = 0;
+			//colors and switches are keyframes too, so they go first
+			if(dynamic_cast<ofxTLColorTrack*>(tracks[t]) != NULL){
+				column.type = OFXTL_EXPORT_RGB;
+				column.range = ofRange(0, 255);
+			}
+			else if(dynamic_cast<ofxTLSwitches*>(tracks[t]) != NULL){
+				column.type = OFXTL_EXPORT_FLOAT;
+				column.range = ofRange(0, 1.0);
+			}
+			else if(dynamic_cast<ofxTLBangs*>(tracks[t]) == NULL && dynamic_cast<ofxTLKeyframes*>(tracks[t]) != NULL){
+				column.type = OFXTL_EXPORT_FLOAT;
+				column.range = ((ofxTLKeyframes*)tracks[t])->getValueRange();
+			}
+			else{
+				//bangs and custom tracks have no value to sample
+				continue;
+			}
+			columns.push_back(column);
+		}
+	}
+}
+
+void ofxTLExporter::sampleColumn(ofxTLExportColumn& column, const vector<unsigned long long>& frameMillis, string& buffer){
+	buffer.resize(getColumnSize(column.type, frameMillis.size()));
+	if(buffer.empty()){
+		return;
+	}
+
+	//frames go in time order, so keyframe tracks find each pair of keys from the last one
+	if(column.type == OFXTL_EXPORT_RGB){
+		ofxTLColorTrack* colors = (ofxTLColorTrack*)column.track;
+		unsigned char* pixels = (unsigned char*)&buffer[0];
+		for(int f = 0; f < frameMillis.size(); f++){
+			ofColor color = colors->getColorAtMillis(frameMillis[f]);
+			pixels[f*3+0] = color.r;
+			pixels[f*3+1] = color.g;
+			pixels[f*3+2] = color.b;
+		}
+	}
+	else if(dynamic_cast<ofxTLSwitches*>(column.track) != NULL){
+		((ofxTLSwitches*)column.track)->sampleOnAtMillis(frameMillis, (float*)&buffer[0]);
+	}
+	else{
+		ofxTLKeyframes* keyframes = (ofxTLKeyframes*)column.track;
+		float* values = (float*)&buffer[0];
+		for(int f = 0; f < frameMillis.size(); f++){
+			values[f] = keyframes->getValueAtTimeInMillis(frameMillis[f]);
+		}
+	}
+}
+
+bool ofxTLExporter::exportBinary(string filePath){
+	if(timeline == NULL){
+		ofLogError("ofxTLExporter::exportBinary") << "Call setup() with a timeline first";
+		return false;
+	}
+
+	ofxTimecode& rate = useOwnFrameRate ? timecode : timeline->getTimecode();
+	unsigned long long startMillis = timeline->getInTimeInMillis();
+	unsigned int numFrames = MAX(rate.frameForMillis(timeline->getOutTimeInMillis() - startMillis), 1);
+
+	vector<ofxTLExportColumn> columns;
+	collectColumns(columns);
+
+	//every column samples the same times
+	vector<unsigned long long> frameMillis(numFrames);
+	for(int f = 0; f < numFrames; f++){
+		frameMillis[f] = startMillis + rate.millisForFrame(f);
+	}
+
+	//the header size doesn't depend on the offsets, so work it out first and lay the columns out after it
+	size_t headerSize = 4 + sizeof(unsigned int)*2 + sizeof(int)*2 + sizeof(unsigned long long) + sizeof(unsigned int)*2;
+	for(int i = 0; i < columns.size(); i++){
+		headerSize += sizeof(unsigned int) + columns[i].name.size() + sizeof(unsigned int) + sizeof(float)*2 + sizeof(unsigned long long);
+	}
+	unsigned long long offset = headerSize + (OFXTL_EXPORT_ALIGNMENT - headerSize % OFXTL_EXPORT_ALIGNMENT) % OFXTL_EXPORT_ALIGNMENT;
+	for(int i = 0; i < columns.size(); i++){
+		columns[i].offset = offset;
+		offset += getColumnSize(columns[i].type, numFrames);
+		offset += (OFXTL_EXPORT_ALIGNMENT - offset % OFXTL_EXPORT_ALIGNMENT) % OFXTL_EXPORT_ALIGNMENT;
+	}
+
+	string header;
+	header.append(OFXTL_EXPORT_MAGIC, 4);
+	ofxTLSerialization::appendValue(header, (unsigned int)OFXTL_EXPORT_VERSION);
+	ofxTLSerialization::appendValue(header, (unsigned int)OFXTL_EXPORT_BYTE_ORDER);
+	ofxTLSerialization::appendValue(header, rate.getFPSNumerator());
+	ofxTLSerialization::appendValue(header, rate.getFPSDenominator());
+	ofxTLSerialization::appendValue(header, startMillis);
+	ofxTLSerialization::appendValue(header, numFrames);
+	ofxTLSerialization::appendValue(header, (unsigned int)columns.size());
+	for(int i = 0; i < columns.size(); i++){
+		ofxTLSerialization::appendValue(header, (unsigned int)columns[i].name.size());
+		header.append(columns[i].name);
+		ofxTLSerialization::appendValue(header, (unsigned int)columns[i].type);
+		ofxTLSerialization::appendValue(header, columns[i].range.min);
+		ofxTLSerialization::appendValue(header, columns[i].range.max);
+		ofxTLSerialization::appendValue(header, columns[i].offset);
+	}
+	padToAlignment(header);
+
+	string path = ofToDataPath(filePath);
+	string tempPath = path + ".tmp";
+	ofstream out(tempPath.c_str(), ios::out | ios::binary | ios::trunc);
+	if(!out.is_open()){
+		ofLogError("ofxTLExporter::exportBinary") << "Couldn't open " << tempPath << " for writing";
+		return false;
+	}
+	out.write(header.data(), header.size());
+
+	//sample a few columns per thread at a time and write them out in order,
+	//so memory stays at a handful of columns however many tracks there are
+	int batchSize = (workerPool.getNumWorkers() + 1) * 2;
+	vector<string> buffers(batchSize);
+	for(int batchStart = 0; batchStart < columns.size() && out.good(); batchStart += batchSize){
+		int batchCount = MIN(batchSize, (int)columns.size() - batchStart);
+		workerPool.parallelFor(batchCount, [&](int i){
+			sampleColumn(columns[batchStart + i], frameMillis, buffers[i]);
+			padToAlignment(buffers[i]);
+		});
+		for(int i = 0; i < batchCount; i++){
+			out.write(buffers[i].data(), buffers[i].size());
+		}
+	}
+
+	out.close();
+	if(out.fail()){
+		ofLogError("ofxTLExporter::exportBinary") << "Couldn't write " << tempPath;
+		ofFile::removeFile(tempPath, false);
+		return false;
+	}
+	return ofxTLSaveJob::replaceFile(tempPath, path);
+}
+
+bool ofxTLExporter::exportCSV(string filePath){
+	string binaryPath = ofToDataPath(filePath) + ".tlx";
+	bool exported = exportBinary(binaryPath) && convertToCSV(binaryPath, filePath);
+	ofFile::removeFile(binaryPath, false);
+	return exported;
+}
+
+bool ofxTLExporter::readHeader(const char* data, size_t size, ofxTLExportHeader& header){
+	const char* end = data + size;
+	unsigned int version, byteOrder, numColumns;
+	if(size < 4 || memcmp(data, OFXTL_EXPORT_MAGIC, 4) != 0){
+		ofLogError("ofxTLExporter::readHeader") << "Not an exported timeline file";
+		return false;
+	}
+	data += 4;
+	if(!ofxTLSerialization::readValue(data, end, version) || !ofxTLSerialization::readValue(data, end, byteOrder) ||
+	   version != OFXTL_EXPORT_VERSION || byteOrder != OFXTL_EXPORT_BYTE_ORDER)
+	{
+		ofLogError("ofxTLExporter::readHeader") << "Unsupported version or byte order";
+		return false;
+	}
+	if(!ofxTLSerialization::readValue(data, end, header.fpsNumerator) || !ofxTLSerialization::readValue(data, end, header.fpsDenominator) ||
+	   !ofxTLSerialization::readValue(data, end, header.startMillis) || !ofxTLSerialization::readValue(data, end, header.numFrames) ||
+	   !ofxTLSerialization::readValue(data, end, numColumns))
+	{
+		ofLogError("ofxTLExporter::readHeader") << "The header is cut short";
+		return false;
+	}
+
+	header.columns.clear();
+	for(int i = 0; i < numColumns; i++){
+		ofxTLExportColumn column;
+		unsigned int nameLength, type;
+		if(!ofxTLSerialization::readValue(data, end, nameLength) || end - data < nameLength){
+			ofLogError("ofxTLExporter::readHeader") << "The header is cut short";
+			return false;
+		}
+		column.name.assign(data, nameLength);
+		data += nameLength;
+		if(!ofxTLSerialization::readValue(data, end, type) || !ofxTLSerialization::readValue(data, end, column.range.min) ||
+		   !ofxTLSerialization::readValue(data, end, column.range.max) || !ofxTLSerialization::readValue(data, end, column.offset))
+		{
+			ofLogError("ofxTLExporter::readHeader") << "The header is cut short";
+			return false;
+		}
+		column.type = (ofxTLExportColumnType)type;
+		column.track = NULL;
+		if((type != OFXTL_EXPORT_FLOAT && type != OFXTL_EXPORT_RGB) ||
+		   column.offset > size || size - column.offset < getColumnSize(column.type, header.numFrames))
+		{
+			ofLogError("ofxTLExporter::readHeader") << "Column " << column.name << " is damaged";
+			return false;
+		}
+		header.columns.push_back(column);
+	}
+	return true;
+}
+
+bool ofxTLExporter::convertToCSV(string binaryPath, string csvPath){
+	ofxTLMappedFile file;
+	if(!file.open(ofToDataPath(binaryPath))){
+		ofLogError("ofxTLExporter::convertToCSV") << "Couldn't open " << binaryPath;
+		return false;
+	}
+	ofxTLExportHeader header;
+	if(!readHeader(file.getData(), file.size(), header)){
+		return false;
+	}
+
+	string path = ofToDataPath(csvPath);
+	string tempPath = path + ".tmp";
+	ofstream out(tempPath.c_str(), ios::out | ios::binary | ios::trunc);
+	if(!out.is_open()){
+		ofLogError("ofxTLExporter::convertToCSV") << "Couldn't open " << tempPath << " for writing";
+		return false;
+	}
+
+	string rows = "frame,millis";
+	for(int i = 0; i < header.columns.size(); i++){
+		string name = header.columns[i].name;
+		if(header.columns[i].type == OFXTL_EXPORT_RGB){
+			rows += "," + ofxTLSerialization::csvField(name + ".r") + "," + ofxTLSerialization::csvField(name + ".g") + "," + ofxTLSerialization::csvField(name + ".b");
+		}
+		else{
+			rows += "," + ofxTLSerialization::csvField(name);
+		}
+	}
+	rows += "\n";
+
+	ofxTimecode rate;
+	rate.setFPS(header.fpsNumerator, header.fpsDenominator);
+	char field[64];
+	for(int f = 0; f < header.numFrames && out.good(); f++){
+		int length = snprintf(field, sizeof(field), "%d,%llu", f, header.startMillis + rate.millisForFrame(f));
+		rows.append(field, length);
+		for(int i = 0; i < header.columns.size(); i++){
+			const char* column = file.getData() + header.columns[i].offset;
+			if(header.columns[i].type == OFXTL_EXPORT_RGB){
+				const unsigned char* pixel = (const unsigned char*)column + f*3;
+				length = snprintf(field, sizeof(field), ",%d,%d,%d", pixel[0], pixel[1], pixel[2]);
+			}
+			else{
+				float value;
+				memcpy(&value, column + f*sizeof(float), sizeof(float));
+				length = snprintf(field, sizeof(field), ",%g", value);
+			}
+			rows.append(field, length);
+		}
+		rows += '\n';
+
+		//write in big blocks rather than row by row
+		if(rows.size() > 1 << 20){
+			out.write(rows.data(), rows.size());
+			rows.clear();
+		}
+	}
+	out.write(rows.data(), rows.size());
+
+	out.close();
+	if(out.fail()){
+		ofLogError("ofxTLExporter::convertToCSV") << "Couldn't write " << tempPath;
+		ofFile::removeFile(tempPath, false);
+		return false;
+	}
+	return ofxTLSaveJob::replaceFile(tempPath, path);
+}
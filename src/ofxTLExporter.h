@@ -0,0 +1,112 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofRange.h"
+#include "ofxTimecode.h"
+#include "ofxTLWorkerPool.h"
+
+//samples every curve, LFO, switch and color track at a fixed rate across the in/out
+//range and writes them to a columnar binary file with one contiguous column per track.
+//columns are sampled side by side on worker threads and written out as they finish.
+//
+//"ofTX" [version] [byte order] [fps numerator] [fps denominator] [start millis] [# frames] [# columns]
+//then for each column [name length][name] [type] [range min] [range max] [data offset]
+//
+//float columns are one float per frame in the track's value range, switches are 0 or 1.
+//rgb columns are three unsigned chars per frame. every column starts on an 8 byte
+//boundary so a mapped file can be read as arrays directly
+//
+//  ofxTLExporter exporter;
+//  exporter.setup(&timeline);
+//  exporter.exportBinary("show.tlx");
+//  ofxTLExporter::convertToCSV("show.tlx", "show.csv");
+enum ofxTLExportColumnType {
+	OFXTL_EXPORT_FLOAT = 0,
+	OFXTL_EXPORT_RGB = 1
+};
+
+class ofxTLTrack;
+class ofxTLExportColumn {
+  public:
+	string name;
+	ofxTLExportColumnType type;
+	ofRange range;
+	unsigned long long offset; //from the start of the file
+	ofxTLTrack* track; //only set while exporting
+};
+
+class ofxTLExportHeader {
+  public:
+	int fpsNumerator;
+	int fpsDenominator;
+	unsigned long long startMillis;
+	unsigned int numFrames;
+	vector<ofxTLExportColumn> columns;
+};
+
+class ofxTimeline;
+class ofxTLExporter {
+  public:
+	ofxTLExporter();
+	virtual ~ofxTLExporter();
+
+	void setup(ofxTimeline* timeline);
+
+	//samples at the timeline's frame rate unless one is set here
+	void setSampleRate(int fpsNumerator, int fpsDenominator = 1);
+	void useTimelineFrameRate();
+	//passing 0 uses one less than the number of hardware threads
+	void setNumThreads(int numThreads);
+
+	//written next to filePath and moved over it once complete
+	bool exportBinary(string filePath);
+	//exports and then converts, the binary file is removed afterwards
+	bool exportCSV(string filePath);
+
+	//checks an exported file and reads everything before the columns
+	static bool readHeader(const char* data, size_t size, ofxTLExportHeader& header);
+	//one row per frame with frame, millis and a column per track, three for color tracks
+	static bool convertToCSV(string binaryPath, string csvPath);
+
+  protected:
+	ofxTimeline* timeline;
+	ofxTimecode timecode;
+	bool useOwnFrameRate;
+	ofxTLWorkerPool workerPool;
+
+	void collectColumns(vector<ofxTLExportColumn>& columns);
+	void sampleColumn(ofxTLExportColumn& column, const vector<unsigned long long>& frameMillis, string& buffer);
+	static size_t getColumnSize(ofxTLExportColumnType type, unsigned int numFrames);
+};
@@ -0,0 +1,282 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLJournal.h"
+#include "ofxTLChecksum.h"
+#include "ofxTLSerialization.h"
+
+//a record is [payload size][crc32 of payload][payload],
+//the payload is [type][name size][name][removed size][removed][written]
+#define OFXTL_JOURNAL_EDIT 0
+#define OFXTL_JOURNAL_COMPACTED 1
+
+ofxTLJournal::ofxTLJournal()
+:	size(0)
+{
+
+}
+
+ofxTLJournal::~ofxTLJournal(){
+	close();
+}
+
+bool ofxTLJournal::open(const string& journalPath){
+	close();
+	path = journalPath;
+	file.open(path.c_str(), ios::out | ios::binary | ios::app);
+	if(!file.is_open()){
+		ofLogError("ofxTLJournal::open") << "Couldn't open " << path << " for writing";
+		return false;
+	}
+	size = ofFile(path, ofFile::Reference).getSize();
+	return true;
+}
+
+void ofxTLJournal::close(){
+	if(file.is_open()){
+		file.close();
+	}
+	size = 0;
+}
+
+bool ofxTLJournal::isOpen(){
+	return file.is_open();
+}
+
+string ofxTLJournal::getPath(){
+	return path;
+}
+
+static string compactingPathFor(const string& path){
+	return path + ".compacting";
+}
+
+string ofxTLJournal::getCompactingPath(){
+	return compactingPathFor(path);
+}
+
+unsigned long long ofxTLJournal::getSize(){
+	return size;
+}
+
+bool ofxTLJournal::append(const string& trackName, const string& removed, const string& written){
+	return appendRecord(OFXTL_JOURNAL_EDIT, trackName, removed, written);
+}
+
+bool ofxTLJournal::appendCompacted(const string& trackName){
+	return appendRecord(OFXTL_JOURNAL_COMPACTED, trackName, "", "");
+}
+
+bool ofxTLJournal::appendRecord(char type, const string& trackName, const string& removed, const string& written){
+	if(!file.is_open()){
+		return false;
+	}
+	string payload;
+	payload.reserve(1 + sizeof(unsigned int)*2 + trackName.size() + removed.size() + written.size());
+	payload.push_back(type);
+	ofxTLSerialization::appendValue(payload, (unsigned int)trackName.size());
+	payload.append(trackName);
+	ofxTLSerialization::appendValue(payload, (unsigned int)removed.size());
+	payload.append(removed);
+	payload.append(written);
+
+	string header;
+	ofxTLSerialization::appendValue(header, (unsigned int)payload.size());
+	ofxTLSerialization::appendValue(header, ofxTLChecksum::crc32(payload));
+	file.write(header.data(), header.size());
+	file.write(payload.data(), payload.size());
+	//flushed every time so a crash of the app loses nothing that was logged.
+	//not synced, a power cut can still lose what the os hadn't written yet
+	file.flush();
+	if(!file.good()){
+		ofLogError("ofxTLJournal::append") << "Couldn't write to " << path;
+		return false;
+	}
+	size += header.size() + payload.size();
+	return true;
+}
+
+bool ofxTLJournal::rotate(){
+	if(!file.is_open()){
+		return false;
+	}
+	file.close();
+	string compactingPath = compactingPathFor(path);
+	bool moved;
+	if(ofFile(compactingPath, ofFile::Reference).exists()){
+		//whatever the failed compaction didn't mark still has to be replayed before this
+		ifstream in(path.c_str(), ios::in | ios::binary);
+		ofstream out(compactingPath.c_str(), ios::out | ios::binary | ios::app);
+		out << in.rdbuf();
+		out.close();
+		moved = !out.fail();
+	}
+	else{
+		moved = ofxTLSaveJob::replaceFile(path, compactingPath);
+	}
+	if(!moved){
+		ofLogError("ofxTLJournal::rotate") << "Couldn't move " << path << " to " << compactingPath;
+		file.open(path.c_str(), ios::out | ios::binary | ios::app);
+		return false;
+	}
+	file.open(path.c_str(), ios::out | ios::binary | ios::trunc);
+	size = 0;
+	return file.is_open();
+}
+
+bool ofxTLJournal::clear(){
+	if(file.is_open()){
+		file.close();
+	}
+	ofFile::removeFile(compactingPathFor(path), false);
+	file.open(path.c_str(), ios::out | ios::binary | ios::trunc);
+	size = 0;
+	return file.is_open();
+}
+
+bool ofxTLJournal::read(const string& journalPath, vector<Entry>& entries){
+	ifstream in(journalPath.c_str(), ios::in | ios::binary);
+	if(!in.is_open()){
+		return true;
+	}
+	string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	const char* data = contents.data();
+	const char* end = data + contents.size();
+	while(data < end){
+		unsigned int payloadSize;
+		unsigned int checksum;
+		if(!ofxTLSerialization::readValue(data, end, payloadSize) || !ofxTLSerialization::readValue(data, end, checksum) || payloadSize == 0 || end - data < (ptrdiff_t)payloadSize ||
+		   ofxTLChecksum::crc32(data, payloadSize) != checksum)
+		{
+			ofLogError("ofxTLJournal::read") << journalPath << " ends with a damaged record, the edits before it are kept";
+			return false;
+		}
+
+		const char* payload = data;
+		const char* payloadEnd = data + payloadSize;
+		data = payloadEnd;
+
+		Entry entry;
+		unsigned int nameSize;
+		unsigned int removedSize;
+		char type = *payload++;
+		if(!ofxTLSerialization::readValue(payload, payloadEnd, nameSize) || payloadEnd - payload < (ptrdiff_t)nameSize){
+			return false;
+		}
+		entry.trackName.assign(payload, nameSize);
+		payload += nameSize;
+		if(!ofxTLSerialization::readValue(payload, payloadEnd, removedSize) || payloadEnd - payload < (ptrdiff_t)removedSize){
+			return false;
+		}
+		entry.compacted = type == OFXTL_JOURNAL_COMPACTED;
+		entry.removed.assign(payload, removedSize);
+		payload += removedSize;
+		entry.written.assign(payload, payloadEnd - payload);
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+void ofxTLJournal::readForRecovery(const string& path, vector<Entry>& edits){
+	vector<Entry> entries;
+	read(compactingPathFor(path), entries);
+	//a compacted mark covers what came before it for that track
+	std::set<string> compacted;
+	vector<bool> keep(entries.size(), false);
+	for(int i = entries.size()-1; i >= 0; i--){
+		if(entries[i].compacted){
+			compacted.insert(entries[i].trackName);
+		}
+		else{
+			keep[i] = compacted.find(entries[i].trackName) == compacted.end();
+		}
+	}
+	for(int i = 0; i < entries.size(); i++){
+		if(keep[i]){
+			edits.push_back(entries[i]);
+		}
+	}
+
+	//the live log started from what the compaction wrote, so all of it applies
+	entries.clear();
+	read(path, entries);
+	for(int i = 0; i < entries.size(); i++){
+		if(!entries[i].compacted){
+			edits.push_back(entries[i]);
+		}
+	}
+}
+
+void ofxTLJournal::remove(const string& path){
+	ofFile::removeFile(compactingPathFor(path), false);
+	ofFile::removeFile(path, false);
+}
+
+ofxTLJournalCompaction::ofxTLJournalCompaction(const string& compactingPath)
+:	ofxTLSaveJob(NULL),
+	compactingPath(compactingPath)
+{
+
+}
+
+ofxTLJournalCompaction::~ofxTLJournalCompaction(){
+	for(int i = 0; i < jobs.size(); i++){
+		delete jobs[i];
+	}
+}
+
+void ofxTLJournalCompaction::addTrack(const string& trackName, ofxTLSaveJob* job){
+	trackNames.push_back(trackName);
+	jobs.push_back(job);
+}
+
+bool ofxTLJournalCompaction::write(){
+	ofxTLJournal marks;
+	if(!marks.open(compactingPath)){
+		return false;
+	}
+	bool allWritten = true;
+	for(int i = 0; i < jobs.size(); i++){
+		if(jobs[i] == NULL || jobs[i]->write()){
+			marks.appendCompacted(trackNames[i]);
+		}
+		else{
+			allWritten = false;
+		}
+	}
+	marks.close();
+	//anything that didn't make it stays logged for the next compaction or for recovery
+	if(allWritten){
+		ofFile::removeFile(compactingPath, false);
+	}
+	return allWritten;
+}
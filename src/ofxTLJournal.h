@@ -0,0 +1,107 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxTLAutosaver.h"
+
+//an append only log of edits, one record per change to a track, so saving costs
+//as much as the change rather than the whole track. records are checksummed so
+//reading stops cleanly at one that was cut off by a crash.
+//records are flushed to the os but not synced to the disk, so they survive the app
+//crashing but not the machine losing power, same as the track files
+class ofxTLJournal {
+  public:
+	ofxTLJournal();
+	virtual ~ofxTLJournal();
+
+	//opens the log for appending, creating it if it isn't there
+	bool open(const string& path);
+	void close();
+	bool isOpen();
+	string getPath();
+	//where rotate() moves the log to
+	string getCompactingPath();
+	unsigned long long getSize();
+
+	//removed and written are undo records, see ofxTLKeyframes::storeUndoRecords
+	bool append(const string& trackName, const string& removed, const string& written);
+	//marks that everything logged for the track before this is in its file now
+	bool appendCompacted(const string& trackName);
+
+	//starts an empty log, moving what's there to getCompactingPath().
+	//if that's still around from a compaction that failed this goes on the end of it
+	bool rotate();
+	//empties the log and removes anything left from compacting
+	bool clear();
+
+	typedef struct {
+		string trackName;
+		bool compacted;
+		string removed;
+		string written;
+	} Entry;
+
+	//reads every whole record, returns false if the log ends with a damaged one
+	static bool read(const string& path, vector<Entry>& entries);
+	//the edits a crash left in the log at path and in what it was compacting,
+	//in order and without the ones that made it into their track's file
+	static void readForRecovery(const string& path, vector<Entry>& edits);
+	//deletes the log at path and its compacting copy
+	static void remove(const string& path);
+
+  protected:
+	bool appendRecord(char type, const string& trackName, const string& removed, const string& written);
+
+	string path;
+	ofstream file;
+	unsigned long long size;
+};
+
+//writes the tracks of a rotated journal to their files and removes it when they all made it.
+//each one that's written gets marked in the rotated log so recovery doesn't apply it twice
+class ofxTLJournalCompaction : public ofxTLSaveJob {
+  public:
+	ofxTLJournalCompaction(const string& compactingPath);
+	virtual ~ofxTLJournalCompaction();
+
+	//takes ownership of the job, NULL if the track has been saved already
+	void addTrack(const string& trackName, ofxTLSaveJob* job);
+
+	virtual bool write();
+
+  protected:
+	string compactingPath;
+	vector<string> trackNames;
+	vector<ofxTLSaveJob*> jobs;
+};
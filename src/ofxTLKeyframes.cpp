@@ -32,28 +32,635 @@
 
 #include "ofxTLKeyframes.h"
 #include "ofxTimeline.h"
+#include "ofxTLChecksum.h"
+#include <typeindex>
 
 bool keyframesort(ofxTLKeyframe* a, ofxTLKeyframe* b){
 	return a->time < b->time;
 }
 
+static bool timeIsBeforeKeyframe(unsigned long long time, ofxTLKeyframe* key){
+	return time < key->time;
+}
+
+bool ofxTLKeyframes::keyframeIsBeforeTime(ofxTLKeyframe* key, unsigned long long time){
+	return key->time < time;
+}
+
+//mapped records are decoded into keys every thread keeps for each key type,
+//so sampling a mapped track doesn't allocate once a thread has done it once
+class ofxTLMappedScratchKeys {
+  public:
+	~ofxTLMappedScratchKeys(){
+		for(map<std::type_index, pair<ofxTLKeyframe*, ofxTLKeyframe*> >::iterator it = keys.begin(); it != keys.end(); it++){
+			delete it->second.first;
+			delete it->second.second;
+		}
+	}
+	map<std::type_index, pair<ofxTLKeyframe*, ofxTLKeyframe*> > keys;
+};
+static thread_local ofxTLMappedScratchKeys mappedScratchKeys;
+
+ofxTLKeyframeSnapshot::~ofxTLKeyframeSnapshot(){
+	for(int i = 0; i < keyframes.size(); i++){
+		delete keyframes[i];
+	}
+}
+
+ofxTLMappedKeys::ofxTLMappedKeys(ofxTLMappedFile* file, const char* records, unsigned int numKeys, unsigned int recordStride, ofxTLKeyframe* prototype)
+:	numKeys(numKeys),
+	prototype(prototype),
+	file(file),
+	records(records),
+	recordStride(recordStride)
+{
+
+}
+
+ofxTLMappedKeys::~ofxTLMappedKeys(){
+	delete prototype;
+	delete file;
+}
+
+unsigned long long ofxTLMappedKeys::getTime(unsigned int index){
+	//records are [size][time][value]..., and not necessarily aligned
+	unsigned long long time;
+	memcpy(&time, getRecord(index) + sizeof(unsigned int), sizeof(time));
+	return time;
+}
+
+const char* ofxTLMappedKeys::getRecord(unsigned int index){
+	return records + (size_t)index * recordStride;
+}
+
+unsigned int ofxTLMappedKeys::getRecordStride(){
+	return recordStride;
+}
+
+unsigned int ofxTLMappedKeys::upperBound(unsigned long long time){
+	unsigned int low = 0, high = numKeys;
+	while(low < high){
+		unsigned int mid = low + (high - low) / 2;
+		if(getTime(mid) <= time){
+			low = mid + 1;
+		}
+		else{
+			high = mid;
+		}
+	}
+	return low;
+}
+
 ofxTLKeyframes::ofxTLKeyframes()
 :	hoverKeyframe(nullptr),
 	keysAreDraggable(false),
 	keysDidDrag(false),
 	keysDidNudge(false),
 	lastKeyframeIndex(1),
-	lastSampleTime(0),
 	shouldRecomputePreviews(false),
 	createNewOnMouseup(false),
-	useBinarySave(false),
-	valueRange(ofRange(0,1.))
+		useBinarySave(false),
+	useMappedLoad(false),
+	mappedHiddenBegin(0),
+	mappedHiddenEnd(0),
+	valueRange(ofRange(0,1.)),
+	playbackSnapshot(new ofxTLKeyframeSnapshot()),
+	playbackReaders(0),
+	warnedLivePlayback(false),
+	lastUndoId(0),
+	journalSnapshot(NULL)
 {
 	xmlFileName = "_keyframes.xml";
 }
 
 ofxTLKeyframes::~ofxTLKeyframes(){
 	clear();
+	delete playbackSnapshot.load();
+	for(int i = 0; i < retiredSnapshots.size(); i++){
+		delete retiredSnapshots[i];
+	}
+}
+
+ofxTLKeyframe* ofxTLKeyframes::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLKeyframe)){
+		return new ofxTLKeyframe(*key);
+	}
+	return NULL;
+}
+
+ofxTLKeyframe* ofxTLKeyframes::copyKeyframeThroughRecord(ofxTLKeyframe* key){
+	string record;
+	if(!storeKeyRecord(key, record)){
+		return NULL;
+	}
+	ofxTLKeyframe* copy = newKeyframe();
+	//the shared fields first, then whatever the subclass stored
+	*copy = *key;
+	restoreKeyRecord(copy, record.data());
+	return copy;
+}
+
+vector<ofxTLKeyframe*>& ofxTLKeyframes::beginPlaybackRead(){
+	ofxTLKeyframeSnapshot* snapshot;
+	return beginPlaybackRead(snapshot);
+}
+
+vector<ofxTLKeyframe*>& ofxTLKeyframes::beginPlaybackRead(ofxTLKeyframeSnapshot*& snapshot){
+	playbackReaders++;
+	snapshot = playbackSnapshot.load();
+	//no snapshot means the keyframe type couldn't be copied, read live like before
+	if(snapshot == NULL){
+		return keyframes;
+	}
+	return snapshot->keyframes;
+}
+
+void ofxTLKeyframes::endPlaybackRead(){
+	playbackReaders--;
+}
+
+void ofxTLKeyframes::publishChanges(){
+	//subclasses edit keys in place during drags without telling us,
+	//so don't try to be clever about what changed
+	publishKeyframes();
+}
+
+void ofxTLKeyframes::publishKeyframes(){
+	ofxTLKeyframeSnapshot* snapshot = new ofxTLKeyframeSnapshot();
+	snapshot->keyframes.reserve(keyframes.size());
+	for(int i = 0; i < keyframes.size(); i++){
+		//ids go on before copying so undo can match snapshot keys to live ones
+		if(keyframes[i]->undoId == 0){
+			keyframes[i]->undoId = ++lastUndoId;
+		}
+		ofxTLKeyframe* copy = copyKeyframe(keyframes[i]);
+		if(copy == NULL){
+			copy = copyKeyframeThroughRecord(keyframes[i]);
+			snapshot->copiedThroughRecords = true;
+		}
+		if(copy == NULL){
+			if(!warnedLivePlayback){
+				ofLogWarning("ofxTLKeyframes::publishKeyframes") << getName() << " has keys that can't be copied or stored as binary, playback will read them while they're edited";
+				warnedLivePlayback = true;
+			}
+			delete snapshot;
+			snapshot = NULL;
+			break;
+		}
+		snapshot->keyframes.push_back(copy);
+	}
+	//keys can be out of order half way through a drag
+	if(snapshot != NULL){
+		stable_sort(snapshot->keyframes.begin(), snapshot->keyframes.end(), keyframesort);
+		indexPlaybackKeys(snapshot);
+		snapshot->mappedKeys = mappedKeys;
+		snapshot->mappedHiddenBegin = mappedHiddenBegin;
+		snapshot->mappedHiddenEnd = mappedHiddenEnd;
+	}
+
+	std::unique_lock<std::mutex> lock(snapshotLock);
+	retiredSnapshots.push_back(playbackSnapshot.exchange(snapshot));
+	//anyone who could still be reading an old snapshot got in before the exchange,
+	//so once the count drops to zero they are all safe to free unless undo or autosave wants them
+	if(playbackReaders == 0){
+		vector<ofxTLKeyframeSnapshot*> held;
+		for(int i = 0; i < retiredSnapshots.size(); i++){
+			if(retiredSnapshots[i] != NULL && retiredSnapshots[i]->holds > 0){
+				held.push_back(retiredSnapshots[i]);
+			}
+			else{
+				delete retiredSnapshots[i];
+			}
+		}
+		retiredSnapshots.swap(held);
+	}
+}
+
+//undo records are [undoId] followed by a key record, see storeKeyRecord
+static size_t undoRecordLength(const string& records, size_t offset){
+	unsigned int size;
+	memcpy(&size, records.data() + offset + sizeof(unsigned int), sizeof(size));
+	return sizeof(unsigned int)*2 + size;
+}
+
+//(undoId, offset) pairs sorted by id
+static void indexUndoRecords(const string& records, vector< pair<unsigned int, size_t> >& index){
+	size_t offset = 0;
+	while(offset < records.size()){
+		unsigned int undoId;
+		memcpy(&undoId, records.data() + offset, sizeof(undoId));
+		index.push_back(make_pair(undoId, offset));
+		offset += undoRecordLength(records, offset);
+	}
+	sort(index.begin(), index.end());
+}
+
+//walks both sides by id, keeping only keys that were removed, added or changed
+static void diffUndoRecords(const string& before, const string& current, string& changedBefore, string& changedAfter){
+	vector< pair<unsigned int, size_t> > startIndex;
+	vector< pair<unsigned int, size_t> > endIndex;
+	indexUndoRecords(before, startIndex);
+	indexUndoRecords(current, endIndex);
+
+	changedBefore.clear();
+	changedAfter.clear();
+	int s = 0, e = 0;
+	while(s < startIndex.size() || e < endIndex.size()){
+		if(e == endIndex.size() || (s < startIndex.size() && startIndex[s].first < endIndex[e].first)){
+			size_t offset = startIndex[s++].second;
+			changedBefore.append(before, offset, undoRecordLength(before, offset));
+		}
+		else if(s == startIndex.size() || endIndex[e].first < startIndex[s].first){
+			size_t offset = endIndex[e++].second;
+			changedAfter.append(current, offset, undoRecordLength(current, offset));
+		}
+		else{
+			size_t startOffset = startIndex[s++].second;
+			size_t endOffset = endIndex[e++].second;
+			size_t startLength = undoRecordLength(before, startOffset);
+			size_t endLength = undoRecordLength(current, endOffset);
+			if(startLength != endLength || before.compare(startOffset, startLength, current, endOffset, endLength) != 0){
+				changedBefore.append(before, startOffset, startLength);
+				changedAfter.append(current, endOffset, endLength);
+			}
+		}
+	}
+}
+
+ofxTLKeyframesUndoDelta::ofxTLKeyframesUndoDelta(ofxTLKeyframes* track, ofxTLKeyframeSnapshot* startSnapshot)
+:	ofxTLUndoDelta(track),
+	keyframesTrack(track),
+	startSnapshot(startSnapshot)
+{
+
+}
+
+ofxTLKeyframesUndoDelta::ofxTLKeyframesUndoDelta(ofxTLKeyframes* track, string& startRecords)
+:	ofxTLUndoDelta(track),
+	keyframesTrack(track),
+	startSnapshot(NULL)
+{
+	//hang on to every key until finish() knows which ones changed
+	before.swap(startRecords);
+}
+
+ofxTLKeyframesUndoDelta::~ofxTLKeyframesUndoDelta(){
+	if(startSnapshot != NULL){
+		keyframesTrack->releaseSnapshot(startSnapshot);
+	}
+}
+
+void ofxTLKeyframesUndoDelta::finish(){
+	if(startSnapshot != NULL){
+		//only now that we know the track changed is the starting state written out
+		bool stored = keyframesTrack->storeUndoRecords(startSnapshot->keyframes, before);
+		keyframesTrack->releaseSnapshot(startSnapshot);
+		startSnapshot = NULL;
+		if(!stored){
+			ofLogError("ofxTLKeyframesUndoDelta::finish") << "Can't store keyframes for " << track->getName() << ", this action won't be undoable";
+			before.clear();
+			return;
+		}
+	}
+
+	string current;
+	if(!keyframesTrack->storeUndoRecords(current)){
+		ofLogError("ofxTLKeyframesUndoDelta::finish") << "Can't store keyframes for " << track->getName() << ", this action won't be undoable";
+		before.clear();
+		return;
+	}
+
+	string changedBefore;
+	string changedAfter;
+	diffUndoRecords(before, current, changedBefore, changedAfter);
+	before.swap(changedBefore);
+	after.swap(changedAfter);
+}
+
+void ofxTLKeyframesUndoDelta::undo(){
+	string beforeScratch, afterScratch;
+	keyframesTrack->restoreUndoRecords(expand(after, afterScratch), expand(before, beforeScratch));
+}
+
+void ofxTLKeyframesUndoDelta::redo(){
+	string beforeScratch, afterScratch;
+	keyframesTrack->restoreUndoRecords(expand(before, beforeScratch), expand(after, afterScratch));
+}
+
+ofxTLUndoDelta* ofxTLKeyframes::beginUndoDelta(){
+	ofxTLKeyframeSnapshot* snapshot = holdSnapshot();
+	if(snapshot != NULL){
+		return new ofxTLKeyframesUndoDelta(this, snapshot);
+	}
+	string records;
+	if(storeUndoRecords(records)){
+		return new ofxTLKeyframesUndoDelta(this, records);
+	}
+	return ofxTLTrack::beginUndoDelta();
+}
+
+ofxTLSaveJob* ofxTLKeyframes::beginBackgroundSave(){
+	//the snapshot has to be current, a save in the middle of a drag would miss it otherwise
+	publishPendingChanges();
+	ofxTLKeyframeSnapshot* snapshot = holdSnapshot();
+	if(snapshot == NULL){
+		return NULL;
+	}
+	//keys copied through records have to be copied again for xml, which only the main thread can do
+	if(snapshot->copiedThroughRecords){
+		releaseSnapshot(snapshot);
+		return NULL;
+	}
+	return new ofxTLKeyframesSaveJob(this, snapshot);
+}
+
+ofxTLKeyframesSaveJob::ofxTLKeyframesSaveJob(ofxTLKeyframes* track, ofxTLKeyframeSnapshot* snapshot)
+:	ofxTLSaveJob(track),
+	keyframesTrack(track),
+	snapshot(snapshot),
+	useBinary(track->useBinarySave),
+	binaryPath(ofToDataPath(track->getBinaryFileName())),
+	xmlPath(ofToDataPath(track->getXMLFilePath()))
+{
+
+}
+
+ofxTLKeyframesSaveJob::~ofxTLKeyframesSaveJob(){
+	//the autosaver only deletes jobs on the main thread
+	keyframesTrack->releaseSnapshot(snapshot);
+}
+
+bool ofxTLKeyframesSaveJob::write(){
+	if(useBinary && keyframesTrack->writeBinaryFile(binaryPath, snapshot->keyframes, snapshot->mappedKeys.get(), snapshot->mappedHiddenBegin, snapshot->mappedHiddenEnd)){
+		return true;
+	}
+	if(snapshot->mappedKeys){
+		ofLogError("ofxTLKeyframesSaveJob::write") << "Couldn't autosave mapped track " << xmlPath << " as binary";
+		return false;
+	}
+	//some tracks change the key while storing it as xml, so they get copies
+	vector<ofxTLKeyframe*> keys;
+	keys.reserve(snapshot->keyframes.size());
+	for(int i = 0; i < snapshot->keyframes.size(); i++){
+		keys.push_back(keyframesTrack->copyKeyframe(snapshot->keyframes[i]));
+	}
+	bool written = keyframesTrack->writeXMLFile(xmlPath, keys);
+	for(int i = 0; i < keys.size(); i++){
+		delete keys[i];
+	}
+	return written;
+}
+
+bool ofxTLKeyframes::startJournal(){
+	if(journalSnapshot != NULL){
+		releaseSnapshot(journalSnapshot);
+		journalSnapshot = NULL;
+	}
+	journalRecords.clear();
+	if(isMapped()){
+		return false;
+	}
+	publishPendingChanges();
+	journalSnapshot = holdSnapshot();
+	if(journalSnapshot == NULL){
+		return false;
+	}
+	if(!storeUndoRecords(journalSnapshot->keyframes, journalRecords)){
+		releaseSnapshot(journalSnapshot);
+		journalSnapshot = NULL;
+		journalRecords.clear();
+		return false;
+	}
+	return true;
+}
+
+bool ofxTLKeyframes::storeJournalChanges(string& removed, string& written){
+	removed.clear();
+	written.clear();
+	if(journalSnapshot == NULL || isMapped()){
+		return false;
+	}
+	publishPendingChanges();
+	ofxTLKeyframeSnapshot* snapshot = holdSnapshot();
+	if(snapshot == NULL){
+		return false;
+	}
+	if(snapshot == journalSnapshot){
+		releaseSnapshot(snapshot);
+		return true;
+	}
+	//the last side is kept from the previous call, so only the new one is stored
+	string current;
+	current.reserve(journalRecords.size());
+	if(!storeUndoRecords(snapshot->keyframes, current)){
+		releaseSnapshot(snapshot);
+		return false;
+	}
+	diffUndoRecords(journalRecords, current, removed, written);
+	releaseSnapshot(journalSnapshot);
+	journalSnapshot = snapshot;
+	journalRecords.swap(current);
+	return true;
+}
+
+bool ofxTLKeyframes::replayJournalChanges(const string& removed, const string& written){
+	materializeAll();
+
+	//a key that's already gone or already there is skipped, so a change that
+	//made it into the file before the crash does no harm being replayed
+	std::set<ofxTLKeyframe*> deletedKeys;
+	for(size_t offset = 0; offset < removed.size(); offset += undoRecordLength(removed, offset)){
+		ofxTLKeyframe* key = findKeyForRecord(removed.data() + offset + sizeof(unsigned int), keyframes.size(), deletedKeys);
+		if(key != NULL){
+			deletedKeys.insert(key);
+		}
+	}
+	if(deletedKeys.size() > 0){
+		vector<ofxTLKeyframe*> remaining;
+		remaining.reserve(keyframes.size() - deletedKeys.size());
+		for(int i = 0; i < keyframes.size(); i++){
+			if(deletedKeys.find(keyframes[i]) == deletedKeys.end()){
+				remaining.push_back(keyframes[i]);
+			}
+			else{
+				willDeleteKeyframe(keyframes[i]);
+				delete keyframes[i];
+			}
+		}
+		keyframes.swap(remaining);
+		deletedKeys.clear();
+	}
+
+	//new keys go on the end, only the sorted ones before them are searched
+	int sortedCount = keyframes.size();
+	for(size_t offset = 0; offset < written.size(); offset += undoRecordLength(written, offset)){
+		const char* record = written.data() + offset + sizeof(unsigned int);
+		if(findKeyForRecord(record, sortedCount, deletedKeys) == NULL){
+			ofxTLKeyframe* key = newKeyframe();
+			restoreKeyRecord(key, record);
+			keyframes.push_back(key);
+		}
+	}
+
+	selectedKeyframes.clear();
+	selectedKeyframe = nullptr;
+	hoverKeyframe = nullptr;
+	updateKeyframeSort();
+	return true;
+}
+
+ofxTLKeyframe* ofxTLKeyframes::findKeyForRecord(const char* record, int count, std::set<ofxTLKeyframe*>& skip){
+	unsigned int size;
+	unsigned long long time;
+	memcpy(&size, record, sizeof(size));
+	memcpy(&time, record + sizeof(size), sizeof(time));
+
+	int index = lower_bound(keyframes.begin(), keyframes.begin() + count, time,
+							[](ofxTLKeyframe* key, unsigned long long t){ return key->time < t; }) - keyframes.begin();
+	string stored;
+	for(; index < count && keyframes[index]->time == time; index++){
+		if(skip.find(keyframes[index]) != skip.end()){
+			continue;
+		}
+		stored.clear();
+		if(storeKeyRecord(keyframes[index], stored) && stored.size() == sizeof(size) + size && memcmp(stored.data(), record, stored.size()) == 0){
+			return keyframes[index];
+		}
+	}
+	return NULL;
+}
+
+ofxTLKeyframeSnapshot* ofxTLKeyframes::holdSnapshot(){
+	std::unique_lock<std::mutex> lock(snapshotLock);
+	ofxTLKeyframeSnapshot* snapshot = playbackSnapshot.load();
+	if(snapshot != NULL){
+		snapshot->holds++;
+	}
+	return snapshot;
+}
+
+void ofxTLKeyframes::releaseSnapshot(ofxTLKeyframeSnapshot* snapshot){
+	std::unique_lock<std::mutex> lock(snapshotLock);
+	if(--snapshot->holds == 0 && playbackReaders == 0){
+		vector<ofxTLKeyframeSnapshot*>::iterator it = find(retiredSnapshots.begin(), retiredSnapshots.end(), snapshot);
+		if(it != retiredSnapshots.end()){
+			retiredSnapshots.erase(it);
+			delete snapshot;
+		}
+	}
+}
+
+bool ofxTLKeyframes::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	//nothing beyond time and value, but a subclass's keys might have more
+	return typeid(*key) == typeid(ofxTLKeyframe);
+}
+
+bool ofxTLKeyframes::storeUndoRecords(string& buffer){
+	return storeUndoRecords(keyframes, buffer);
+}
+
+bool ofxTLKeyframes::storeUndoRecords(vector<ofxTLKeyframe*>& keys, string& buffer){
+	buffer.clear();
+	buffer.reserve(keys.size() * (sizeof(unsigned int)*2 + sizeof(unsigned long long) + sizeof(float)));
+	for(int i = 0; i < keys.size(); i++){
+		ofxTLKeyframe* key = keys[i];
+		if(key->undoId == 0){
+			key->undoId = ++lastUndoId;
+		}
+		appendBinary(buffer, key->undoId);
+		if(!storeKeyRecord(key, buffer)){
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ofxTLKeyframes::storeKeyRecord(ofxTLKeyframe* key, string& buffer){
+	size_t sizeOffset = buffer.size();
+	appendBinary(buffer, (unsigned int)0);
+	appendBinary(buffer, key->time);
+	appendBinary(buffer, key->value);
+	if(!storeKeyframeBinary(key, buffer)){
+		return false;
+	}
+	unsigned int size = buffer.size() - sizeOffset - sizeof(unsigned int);
+	memcpy(&buffer[sizeOffset], &size, sizeof(size));
+	return true;
+}
+
+void ofxTLKeyframes::restoreKeyRecord(ofxTLKeyframe* key, const char* record){
+	//callers already used the size to find the record
+	record += sizeof(unsigned int);
+	readBinary(record, key->time);
+	key->previousTime = key->time;
+	readBinary(record, key->value);
+	restoreKeyframeBinary(key, record);
+}
+
+void ofxTLKeyframes::restoreUndoRecords(const string& removed, const string& written){
+	map<unsigned int, ofxTLKeyframe*> keysById;
+	for(int i = 0; i < keyframes.size(); i++){
+		if(keyframes[i]->undoId != 0){
+			keysById[keyframes[i]->undoId] = keyframes[i];
+		}
+	}
+
+	vector< pair<unsigned int, size_t> > removedIndex;
+	vector< pair<unsigned int, size_t> > writtenIndex;
+	indexUndoRecords(removed, removedIndex);
+	indexUndoRecords(written, writtenIndex);
+
+	//keys that only exist on the removed side go away
+	std::set<ofxTLKeyframe*> deletedKeys;
+	int w = 0;
+	for(int r = 0; r < removedIndex.size(); r++){
+		while(w < writtenIndex.size() && writtenIndex[w].first < removedIndex[r].first){
+			w++;
+		}
+		if(w < writtenIndex.size() && writtenIndex[w].first == removedIndex[r].first){
+			continue;
+		}
+		map<unsigned int, ofxTLKeyframe*>::iterator it = keysById.find(removedIndex[r].first);
+		if(it != keysById.end()){
+			deletedKeys.insert(it->second);
+			keysById.erase(it);
+		}
+	}
+	if(deletedKeys.size() > 0){
+		vector<ofxTLKeyframe*> remaining;
+		remaining.reserve(keyframes.size() - deletedKeys.size());
+		for(int i = 0; i < keyframes.size(); i++){
+			if(deletedKeys.find(keyframes[i]) == deletedKeys.end()){
+				remaining.push_back(keyframes[i]);
+			}
+			else{
+				willDeleteKeyframe(keyframes[i]);
+				delete keyframes[i];
+			}
+		}
+		keyframes.swap(remaining);
+	}
+
+	//everything on the written side is either overwritten in place or created again
+	for(int i = 0; i < writtenIndex.size(); i++){
+		ofxTLKeyframe* key;
+		map<unsigned int, ofxTLKeyframe*>::iterator it = keysById.find(writtenIndex[i].first);
+		if(it != keysById.end()){
+			key = it->second;
+		}
+		else{
+			key = newKeyframe();
+			key->undoId = writtenIndex[i].first;
+			keyframes.push_back(key);
+		}
+		restoreKeyRecord(key, written.data() + writtenIndex[i].second + sizeof(unsigned int));
+	}
+
+	selectedKeyframes.clear();
+	selectedKeyframe = nullptr;
+	hoverKeyframe = nullptr;
+	updateKeyframeSort();
+	timeline->flagUserChangedValue(); //like loadFromXMLRepresentation this is only called from undo
 }
 
 void ofxTLKeyframes::recomputePreviews(){
@@ -99,6 +706,7 @@ void ofxTLKeyframes::draw(){
 	}
 
 	if(shouldRecomputePreviews || viewIsDirty){
+		OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_PREVIEWS);
 		recomputePreviews();
 	}
 
@@ -147,7 +755,6 @@ void ofxTLKeyframes::draw(){
 			ofVec2f screenpoint = screenPositionForKeyframe(selectedKeyframes[i]);
 			float keysValue = ofMap(selectedKeyframes[i]->value, 0, 1.0, valueRange.min, valueRange.max, true);
 			if(keysAreDraggable){
-				string frameString = timeline->formatTime(selectedKeyframes[i]->time);
 				timeline->getFont().drawString(ofToString(keysValue, 4), screenpoint.x+5, screenpoint.y-5);
 			}
             ofDrawCircle(screenpoint.x, screenpoint.y, 4);
@@ -204,36 +811,88 @@ float ofxTLKeyframes::sampleAtPercent(float percent){
 }
 
 float ofxTLKeyframes::sampleAtTime(long sampleTime){
+	OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_SAMPLE);
 	sampleTime = ofClamp(sampleTime, 0, timeline->getDurationInMilliseconds());
 
+	ofxTLKeyframeSnapshot* snapshot;
+	vector<ofxTLKeyframe*>& keys = beginPlaybackRead(snapshot);
+	float sample = defaultValue;
+
+	if(snapshot != NULL && snapshot->mappedKeys){
+		sample = sampleMappedAtTime(snapshot, sampleTime);
+	}
 	//edge cases
-	if(keyframes.size() == 0){
-		return ofMap(defaultValue, valueRange.min, valueRange.max, 0, 1.0, true);
+	else if(keys.size() == 0){
+		sample = ofMap(defaultValue, valueRange.min, valueRange.max, 0, 1.0, true);
 	}
-
-	if(sampleTime <= keyframes[0]->time){
-		return evaluateKeyframeAtTime(keyframes[0], sampleTime, true);
+	else if(sampleTime <= keys[0]->time){
+		sample = evaluateKeyframeAtTime(keys[0], sampleTime, true);
+	}
+	else if(sampleTime >= keys[keys.size()-1]->time){
+		sample = evaluateKeyframeAtTime(keys[keys.size()-1], sampleTime);
+	}
+	else{
+		//optimization for linear playback, try the pair of keys found last time first.
+		//it's only a hint and checked here, so sampling from several threads at once stays correct
+		int index = lastKeyframeIndex;
+		if(index < 1 || index >= keys.size() || keys[index-1]->time >= sampleTime || keys[index]->time < sampleTime){
+			index = lower_bound(keys.begin(), keys.end(), (unsigned long long)sampleTime, keyframeIsBeforeTime) - keys.begin();
+			lastKeyframeIndex = index;
+		}
+		sample = interpolateValueForKeys(keys[index-1], keys[index], sampleTime);
 	}
 
-	if(sampleTime >= keyframes[keyframes.size()-1]->time){
-		return evaluateKeyframeAtTime(keyframes[keyframes.size()-1], sampleTime);
+	endPlaybackRead();
+	return sample;
+}
+
+float ofxTLKeyframes::sampleMappedAtTime(ofxTLKeyframeSnapshot* snapshot, unsigned long long sampleTime){
+	ofxTLMappedKeys& mapped = *snapshot->mappedKeys;
+	vector<ofxTLKeyframe*>& keys = snapshot->keyframes;
+
+	//neighbours among the edited keys
+	vector<ofxTLKeyframe*>::iterator after = upper_bound(keys.begin(), keys.end(), sampleTime, timeIsBeforeKeyframe);
+	ofxTLKeyframe* prevKey = after != keys.begin() ? *(after-1) : NULL;
+	ofxTLKeyframe* nextKey = after != keys.end() ? *after : NULL;
+
+	//and in the file, stepping around the part that's been copied out for editing
+	long long prevIndex = (long long)mapped.upperBound(sampleTime) - 1;
+	long long nextIndex = prevIndex + 1;
+	if(prevIndex >= snapshot->mappedHiddenBegin && prevIndex < snapshot->mappedHiddenEnd){
+		prevIndex = (long long)snapshot->mappedHiddenBegin - 1;
+	}
+	if(nextIndex >= snapshot->mappedHiddenBegin && nextIndex < snapshot->mappedHiddenEnd){
+		nextIndex = snapshot->mappedHiddenEnd;
 	}
 
-	//optimization for linear playback
-	int startKeyframeIndex = 1;
-	if(sampleTime >= lastSampleTime){
-		startKeyframeIndex = lastKeyframeIndex;
+	pair<ofxTLKeyframe*, ofxTLKeyframe*>& scratch = mappedScratchKeys.keys[std::type_index(typeid(*mapped.prototype))];
+	if(scratch.first == NULL){
+		scratch.first = copyKeyframe(mapped.prototype);
+		scratch.second = copyKeyframe(mapped.prototype);
+	}
+	if(prevIndex >= 0 && (prevKey == NULL || mapped.getTime(prevIndex) > prevKey->time)){
+		restoreKeyRecord(scratch.first, mapped.getRecord(prevIndex));
+		prevKey = scratch.first;
+	}
+	if(nextIndex < mapped.numKeys && (nextKey == NULL || mapped.getTime(nextIndex) < nextKey->time)){
+		restoreKeyRecord(scratch.second, mapped.getRecord(nextIndex));
+		nextKey = scratch.second;
 	}
 
-	for(int i = startKeyframeIndex; i < keyframes.size(); i++){
-		if(keyframes[i]->time >= sampleTime){
-			lastKeyframeIndex = i;
-			lastSampleTime = sampleTime;
-			return interpolateValueForKeys(keyframes[i-1], keyframes[i], sampleTime);
-		}
+	float sample;
+	if(prevKey == NULL && nextKey == NULL){
+		sample = ofMap(defaultValue, valueRange.min, valueRange.max, 0, 1.0, true);
+	}
+	else if(prevKey == NULL){
+		sample = evaluateKeyframeAtTime(nextKey, sampleTime, true);
+	}
+	else if(nextKey == NULL){
+		sample = evaluateKeyframeAtTime(prevKey, sampleTime);
+	}
+	else{
+		sample = interpolateValueForKeys(prevKey, nextKey, sampleTime);
 	}
-	ofLog(OF_LOG_ERROR, "ofxTLKeyframes --- Error condition, couldn't find keyframe for percent " + ofToString(sampleTime));
-	return defaultValue;
+	return sample;
 }
 
 float ofxTLKeyframes::evaluateKeyframeAtTime(ofxTLKeyframe* key, unsigned long long sampleTime, bool firstKey){
@@ -245,69 +904,134 @@ float ofxTLKeyframes::interpolateValueForKeys(ofxTLKeyframe* start,ofxTLKeyframe
 }
 
 void ofxTLKeyframes::load(){
-    clear();
-	if(useBinarySave){
-		loadFromBinaryFile();
+	ofxTLLoadJob* job = beginBackgroundLoad();
+	job->read();
+	job->finish();
+	delete job;
+}
+
+ofxTLLoadJob* ofxTLKeyframes::beginBackgroundLoad(){
+	return new ofxTLKeyframesLoadJob(this);
+}
+
+bool ofxTLKeyframes::canLoadInBackground(){
+	return typeid(*this) == typeid(ofxTLKeyframes);
+}
+
+bool ofxTLKeyframes::canRenderInParallel(){
+	return typeid(*this) == typeid(ofxTLKeyframes);
+}
+
+ofxTLKeyframesLoadJob::ofxTLKeyframesLoadJob(ofxTLKeyframes* track)
+:	ofxTLLoadJob(track),
+	keyframesTrack(track),
+	useBinary(track->useBinarySave),
+	useMapped(track->useBinarySave && track->useMappedLoad && track->canMapBinaryFile()),
+	readInBackground(track->canLoadInBackground() && !useMapped),
+	loaded(false),
+	binaryPath(ofToDataPath(track->getBinaryFileName())),
+	xmlPath(ofToDataPath(track->getXMLFilePath()))
+{
+
+}
+
+ofxTLKeyframesLoadJob::~ofxTLKeyframesLoadJob(){
+	for(int i = 0; i < keys.size(); i++){
+		delete keys[i];
 	}
-	else{
-		ofxXmlSettings savedkeyframes;
-#if OF_VERSION_MAJOR == 0 && OF_VERSION_MINOR < 12
-        if(!savedkeyframes.loadFile(xmlFileName)){
-#else
-        if(!savedkeyframes.load(xmlFileName)){
-#endif
-
-//			ofLog(OF_LOG_NOTICE, "ofxTLKeyframes --- couldn't load xml file " + xmlFileName);
-			return;
-		}
+}
 
-		createKeyframesFromXML(savedkeyframes, keyframes);
+void ofxTLKeyframesLoadJob::read(){
+	if(readInBackground){
+		loaded = keyframesTrack->readKeyframeFiles(binaryPath, xmlPath, useBinary, keys);
 	}
-	updateKeyframeSort();
-	timeline->flagTrackModified(this);
+}
+
+void ofxTLKeyframesLoadJob::finish(){
+	keyframesTrack->clear();
+	//mapping is quick, everything else that couldn't be read on another thread is read now
+	if(!readInBackground){
+		loaded = (useMapped && keyframesTrack->mapBinaryFile()) || keyframesTrack->readKeyframeFiles(binaryPath, xmlPath, useBinary, keys);
+	}
+	if(!loaded){
+		return;
+	}
+	keyframesTrack->keyframes.swap(keys);
+	keyframesTrack->updateKeyframeSort();
+	keyframesTrack->timeline->flagTrackModified(keyframesTrack);
+}
+
+bool ofxTLKeyframes::readKeyframeFiles(const string& binaryPath, const string& xmlPath, bool useBinary, vector<ofxTLKeyframe*>& keyContainer){
+	//a missing or unreadable binary file falls back to xml, which is also how old projects get converted
+	if(useBinary && readBinaryFile(binaryPath, keyContainer)){
+		return true;
+	}
+	if(!ofFile(xmlPath).exists()){
+//		ofLog(OF_LOG_NOTICE, "ofxTLKeyframes --- couldn't load xml file " + xmlPath);
+		return false;
+	}
+	ofBuffer savedkeyframes = ofBufferFromFile(xmlPath);
+	createKeyframesFromXML(savedkeyframes.getData(), savedkeyframes.size(), keyContainer);
+	return true;
 }
 
 void ofxTLKeyframes::createKeyframesFromXML(ofxXmlSettings xmlStore, vector<ofxTLKeyframe*>& keyContainer){
+	string xml;
+	xmlStore.copyXmlToString(xml);
+	createKeyframesFromXML(xml.data(), xml.size(), keyContainer);
+}
+
+void ofxTLKeyframes::createKeyframesFromXML(const char* xml, size_t length, vector<ofxTLKeyframe*>& keyContainer){
+
+	ofxTLXMLKeyReader keyTags(xml, length);
+	while(keyTags.nextKey()){
+		ofxTLKeyframe* key = newKeyframe();
+
+		const char* text;
+		size_t textLength;
+		//if there is a decimal this is most likely an old save so let's
+		//convert it based on the current duration
+		if(keyTags.getText("x", text, textLength)){
+			string legacyX(text, textLength);
+			ofLogNotice() << "ofxTLKeyframes::createKeyframesFromXML -- Found legacy time " + legacyX << endl;
+			float normalizedTime = ofToFloat(legacyX);
+			key->time = key->previousTime =  normalizedTime*timeline->getDurationInMilliseconds();
+		}
+		else if(keyTags.getText("time", text, textLength) && ofxTimecode::millisForTimecode(text, textLength, key->time)){
+			key->previousTime = key->time;
+		}
+		else {
+			string timecode = keyTags.getValue("time", "00:00:00:000");
+			key->time = key->previousTime = timeline->getTimecode().millisForTimecode(timecode);
+		}
+
+		float legacyYValue = keyTags.getValue("y", 0.0);
+		if(legacyYValue != 0.0){
+			ofLogNotice() << "ofxTLKeyframes::createKeyframesFromXML -- Found legacy value " << legacyYValue << endl;
+			key->value = legacyYValue;
+		}
+		else{
+			key->value = keyTags.getValue("value", 0.0);
+		}
+		restoreKeyframeTags(key, keyTags);
+		keyContainer.push_back( key );
+	}
+	//saved tracks are already in order
+	if(!is_sorted(keyContainer.begin(), keyContainer.end(), keyframesort)){
+		sort(keyContainer.begin(), keyContainer.end(), keyframesort);
+	}
+}
 
-	int numKeyframeStores = xmlStore.getNumTags("keyframes");
-	for(int store = 0; store < numKeyframeStores; store++){
-		xmlStore.pushTag("keyframes",store);
-		int numKeyTags = xmlStore.getNumTags("key");
-
-		for(int i = 0; i < numKeyTags; i++){
-			xmlStore.pushTag("key", i);
-			//ofxTLKeyframe* key = newKeyframe(ofVec2f(xmlStore.getValue("x", 0.0),xmlStore.getValue("y", 0.0)));
-            ofxTLKeyframe* key = newKeyframe();
-
-            string legacyX = xmlStore.getValue("x", "");
-            //if there is a decimal this is most likely an old save so let's
-            //convert it based on the current duration
-            if(legacyX != ""){
-                ofLogNotice() << "ofxTLKeyframes::createKeyframesFromXML -- Found legacy time " + legacyX << endl;
-                float normalizedTime = ofToFloat(legacyX);
-                key->time = key->previousTime =  normalizedTime*timeline->getDurationInMilliseconds();
-            }
-            else {
-                string timecode = xmlStore.getValue("time", "00:00:00:000");
-	            key->time = key->previousTime = timeline->getTimecode().millisForTimecode(timecode);
-            }
-
-            float legacyYValue = xmlStore.getValue("y", 0.0);
-            if(legacyYValue != 0.0){
-                ofLogNotice() << "ofxTLKeyframes::createKeyframesFromXML -- Found legacy value " << legacyYValue << endl;
-                key->value = legacyYValue;
-            }
-            else{
-	            key->value = xmlStore.getValue("value", 0.0f);
-            }
-			restoreKeyframe(key, xmlStore);
-			xmlStore.popTag(); //key
-			keyContainer.push_back( key );
-		}
-
-		xmlStore.popTag(); //keyframes
-	}
-	sort(keyContainer.begin(), keyContainer.end(), keyframesort);
+void ofxTLKeyframes::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
+	//plain keys have nothing else to read
+	if(typeid(*this) == typeid(ofxTLKeyframes)){
+		return;
+	}
+	//tracks that only implement restoreKeyframe get a document of just this key
+	ofxXmlSettings xmlStore;
+	xmlStore.loadFromBuffer(keyTags.getKeyXML());
+	xmlStore.pushTag("key");
+	restoreKeyframe(key, xmlStore);
 }
 
 void ofxTLKeyframes::clear(){
@@ -318,24 +1042,103 @@ void ofxTLKeyframes::clear(){
 	}
 	keyframes.clear();
     selectedKeyframes.clear();
+	mappedKeys.reset();
+	mappedHiddenBegin = mappedHiddenEnd = 0;
 	updateKeyframeSort();
 }
 
 void ofxTLKeyframes::save(){
-	if(useBinarySave){
-		saveToBinaryFile();
+	if(!(useBinarySave && saveToBinaryFile())){
+		//xml has no way to refer to the mapped file
+		materializeAll();
+		writeXMLFile(ofToDataPath(xmlFileName), keyframes);
 	}
-	else{
-		string xmlRep = getXMLStringForKeyframes(keyframes);
-		ofxXmlSettings savedkeyframes;
-		savedkeyframes.loadFromBuffer(xmlRep);
-#if OF_VERSION_MAJOR == 0 && OF_VERSION_MINOR < 12
-            savedkeyframes.saveFile(xmlFileName);
-#else
-            savedkeyframes.save(xmlFileName);
-#endif
+}
 
+bool ofxTLKeyframes::writeXMLFile(const string& filePath, vector<ofxTLKeyframe*>& keys){
+	return ofxTLSaveJob::writeFileAtomically(filePath, getXMLStringForKeyframes(keys));
+}
+
+#define OFXTL_CLIPBOARD_MAGIC "ofTC"
+#define OFXTL_CLIPBOARD_BYTE_ORDER 0x01020304
+
+string ofxTLKeyframes::getClipboardForKeyframes(vector<ofxTLKeyframe*>& keys){
+	string clipboard;
+	string trackType = getTrackType();
+	clipboard.reserve(32 + trackType.size() + keys.size() * (sizeof(unsigned int) + sizeof(unsigned long long) + sizeof(float)));
+	clipboard.append(OFXTL_CLIPBOARD_MAGIC, 4);
+	appendBinary(clipboard, (unsigned int)OFXTL_CLIPBOARD_BYTE_ORDER);
+	appendBinary(clipboard, (unsigned int)trackType.size());
+	clipboard.append(trackType);
+	appendBinary(clipboard, (unsigned int)keys.size());
+	for(int i = 0; i < keys.size(); i++){
+		if(!storeKeyRecord(keys[i], clipboard)){
+			return getXMLStringForKeyframes(keys);
+		}
+	}
+	return clipboard;
+}
+
+bool ofxTLKeyframes::createKeyframesFromClipboard(const string& clipboard, vector<ofxTLKeyframe*>& keyContainer){
+	const char* data = clipboard.data();
+	const char* end = data + clipboard.size();
+	unsigned int byteOrder, typeLength, numKeys;
+	if(clipboard.size() < 4 + sizeof(unsigned int)*2 || memcmp(data, OFXTL_CLIPBOARD_MAGIC, 4) != 0){
+		return false;
+	}
+	data += 4;
+	readBinary(data, byteOrder);
+	readBinary(data, typeLength);
+	if(byteOrder != OFXTL_CLIPBOARD_BYTE_ORDER || end - data < typeLength + sizeof(numKeys)){
+		ofLogError("ofxTLKeyframes::createKeyframesFromClipboard") << "Can't paste keys copied on a different machine";
+		return true;
+	}
+	bool sameType = getTrackType().compare(0, string::npos, data, typeLength) == 0;
+	data += typeLength;
+	readBinary(data, numKeys);
+
+	//a damaged count can't make us reserve more keys than there are bytes for
+	size_t minRecordSize = sizeof(unsigned int) + sizeof(unsigned long long) + sizeof(float);
+	keyContainer.reserve(keyContainer.size() + MIN((size_t)numKeys, (size_t)(end - data) / minRecordSize));
+	//every key of a type stores a record of the same size, a fresh key tells us how big
+	size_t typeRecordSize = 0;
+	for(unsigned int i = 0; i < numKeys; i++){
+		unsigned int recordSize;
+		if(end - data < sizeof(recordSize)){
+			break;
+		}
+		memcpy(&recordSize, data, sizeof(recordSize));
+		if(end - data - sizeof(recordSize) < recordSize || recordSize < sizeof(unsigned long long) + sizeof(float)){
+			break;
+		}
+		ofxTLKeyframe* key = newKeyframe();
+		if(sameType && typeRecordSize == 0){
+			string typeRecord;
+			if(storeKeyRecord(key, typeRecord)){
+				typeRecordSize = typeRecord.size() - sizeof(unsigned int);
+			}
+		}
+		if(sameType && recordSize == typeRecordSize){
+			restoreKeyRecord(key, data);
+		}
+		else if(sameType){
+			//restoreKeyframeBinary would read past the end of the record
+			ofLogError("ofxTLKeyframes::createKeyframesFromClipboard") << "Can't paste a " << getTrackType() << " key of " << recordSize << " bytes";
+			delete key;
+			break;
+		}
+		else{
+			//the rest of the record belongs to the other track type
+			const char* record = data + sizeof(recordSize);
+			readBinary(record, key->time);
+			key->previousTime = key->time;
+			readBinary(record, key->value);
+			restorePastedKeyframe(key);
+		}
+		keyContainer.push_back(key);
+		data += sizeof(recordSize) + recordSize;
 	}
+	return true;
 }
 
 string ofxTLKeyframes::getXMLStringForKeyframes(vector<ofxTLKeyframe*>& keys){
@@ -365,6 +1168,11 @@ string ofxTLKeyframes::getXMLStringForKeyframes(vector<ofxTLKeyframe*>& keys){
 bool ofxTLKeyframes::mousePressed(ofMouseEventArgs& args, long millis){
 
 	ofVec2f screenpoint = ofVec2f(args.x, args.y);
+	//clicking into a mapped track makes what's on screen editable. this happens
+	//before the undo state is collected so it's never part of an action
+	if(mappedKeys && bounds.inside(screenpoint)){
+		materializeRange(screenXToMillis(bounds.getMinX()), screenXToMillis(bounds.getMaxX()));
+	}
     keysAreStretchable = ofGetKeyPressed(OF_KEY_SHIFT) && ofGetKeyPressed(OF_KEY_CONTROL);
 
     constrainVerticalDrag = ofGetKeyPressed(OF_KEY_ALT) ? args.y : 0.0f;
@@ -411,7 +1219,8 @@ bool ofxTLKeyframes::mousePressed(ofMouseEventArgs& args, long millis){
          //add the keyframe to the selection, whether it was just generated or not
     	if(!isKeyframeSelected(selectedKeyframe)){
 			selectedKeyframes.push_back(selectedKeyframe);
-			updateKeyframeSort();
+			//only the selection changed, so nothing is published
+			sort(selectedKeyframes.begin(), selectedKeyframes.end(), keyframesort);
 //			selectKeyframe(selectedKeyframe);
         }
         //unselect it if it's selected and we clicked the key with shift pressed
@@ -443,12 +1252,13 @@ bool ofxTLKeyframes::mousePressed(ofMouseEventArgs& args, long millis){
 }
 
 void ofxTLKeyframes::regionSelected(ofLongRange timeRange, ofRange valueRange){
+	materializeRange(timeRange.min, timeRange.max);
     for(int i = 0; i < keyframes.size(); i++){
         if(timeRange.contains(keyframes[i]->time) && valueRange.contains(1.-keyframes[i]->value)){
             selectKeyframe(keyframes[i]);
         }
 	}
-	updateKeyframeSort();
+	sort(selectedKeyframes.begin(), selectedKeyframes.end(), keyframesort);
 }
 
 //update the grabTimeOffset to prepare for stretching keys
@@ -512,7 +1322,6 @@ void ofxTLKeyframes::updateKeyframeSort(){
 	//reset these caches because they may no longer be valid
 	shouldRecomputePreviews = true;
 	lastKeyframeIndex = 1;
-	lastSampleTime = 0;
 	if(keyframes.size() > 1){
 		//modify duration to fit
 		for(int i = 0; i < keyframes.size(); i++){
@@ -522,7 +1331,9 @@ void ofxTLKeyframes::updateKeyframeSort(){
 			}
 		}
 
-		sort(keyframes.begin(), keyframes.end(), keyframesort);
+		if(!is_sorted(keyframes.begin(), keyframes.end(), keyframesort)){
+			sort(keyframes.begin(), keyframes.end(), keyframesort);
+		}
 
 		for(int i = 0; i < keyframes.size()-1; i++){
 			if(keyframes[i]->time == keyframes[i+1]->time){
@@ -538,6 +1349,8 @@ void ofxTLKeyframes::updateKeyframeSort(){
 			sort(selectedKeyframes.begin(), selectedKeyframes.end(), keyframesort);
 		}
 	}
+
+	markChanged();
 }
 
 void ofxTLKeyframes::mouseReleased(ofMouseEventArgs& args, long millis){
@@ -545,7 +1358,6 @@ void ofxTLKeyframes::mouseReleased(ofMouseEventArgs& args, long millis){
     if(keysDidDrag){
 		//reset these caches because they may no longer be valid
 		lastKeyframeIndex = 1;
-		lastSampleTime = 0;
         timeline->flagTrackModified(this);
     }
 
@@ -575,59 +1387,86 @@ void ofxTLKeyframes::getSnappingPoints(std::set<unsigned long long>& points){
 	}
 }
 
+bool ofxTLKeyframes::updateSnapIndex(vector<unsigned long long>& index){
+	index.reserve(keyframes.size());
+	for(int i = 0; i < keyframes.size(); i++){
+		if(index.empty() || index.back() != keyframes[i]->time){
+			index.push_back(keyframes[i]->time);
+		}
+	}
+	//keys can be out of order half way through a drag
+	if(!is_sorted(index.begin(), index.end())){
+		sort(index.begin(), index.end());
+		index.erase(unique(index.begin(), index.end()), index.end());
+	}
+	return true;
+}
+
+void ofxTLKeyframes::getSelectedSnappingPoints(vector<unsigned long long>& points){
+	for(int i = 0; i < selectedKeyframes.size(); i++){
+		points.push_back(selectedKeyframes[i]->time);
+	}
+}
+
 vector<ofxTLKeyframe*>& ofxTLKeyframes::getKeyframes(){
     return keyframes;
 }
 
 string ofxTLKeyframes::copyRequest(){
 	if(selectedKeyframes.size() > 0){
-		return getXMLStringForKeyframes(selectedKeyframes);
+		//selection order follows the clicks
+		vector<ofxTLKeyframe*> keys = selectedKeyframes;
+		if(!is_sorted(keys.begin(), keys.end(), keyframesort)){
+			stable_sort(keys.begin(), keys.end(), keyframesort);
+		}
+		return getClipboardForKeyframes(keys);
 	}
 	return "";
 }
 
 string ofxTLKeyframes::cutRequest(){
 	if(selectedKeyframes.size() > 0){
-		string xmlrep = getXMLStringForKeyframes(selectedKeyframes);
+		string clipboard = copyRequest();
 		deleteSelectedKeyframes();
-		return xmlrep;
+		return clipboard;
 	}
 	return "";
 }
 
 void ofxTLKeyframes::pasteSent(string pasteboard){
 	vector<ofxTLKeyframe*> keyContainer;
-	ofxXmlSettings pastedKeys;
-
-	if(pastedKeys.loadFromBuffer(pasteboard)){
-		createKeyframesFromXML(pastedKeys, keyContainer);
-		if(keyContainer.size() != 0){
-			timeline->unselectAll();
-			int numKeyframesPasted = 0;
-			//normalize and add at playhead
-			//for(int i = 0; i < keyContainer.size(); i++){
-			for(int i = keyContainer.size()-1; i >= 0; i--){
-				keyContainer[i]->time -= keyContainer[0]->time;
-				keyContainer[i]->time += timeline->getCurrentTimeMillis();
-				if(keyContainer[i]->time <= timeline->getDurationInMilliseconds()){
-					selectedKeyframes.push_back(keyContainer[i]);
-					keyframes.push_back(keyContainer[i]);
-					numKeyframesPasted++;
-				}
-				else{
-					delete keyContainer[i];
-				}
-			}
 
-			if(numKeyframesPasted > 0){
-				updateKeyframeSort();
-				timeline->flagTrackModified(this);
+	if(!createKeyframesFromClipboard(pasteboard, keyContainer)){
+		createKeyframesFromXML(pasteboard.data(), pasteboard.size(), keyContainer);
+	}
+	if(keyContainer.size() != 0){
+		timeline->unselectAll();
+		//normalize and add at playhead
+		unsigned long long firstTime = keyContainer[0]->time;
+		unsigned long long pasteTime = timeline->getCurrentTimeMillis();
+		unsigned long long duration = timeline->getDurationInMilliseconds();
+		for(int i = 0; i < keyContainer.size(); i++){
+			keyContainer[i]->time = keyContainer[i]->time - firstTime + pasteTime;
+			if(keyContainer[i]->time <= duration){
+				selectedKeyframes.push_back(keyContainer[i]);
 			}
+			else{
+				delete keyContainer[i];
+			}
+		}
+
+		if(selectedKeyframes.size() > 0){
+			//both sides are already in order so one merge does it, updateKeyframeSort won't need to sort again
+			size_t middle = keyframes.size();
+			keyframes.insert(keyframes.end(), selectedKeyframes.begin(), selectedKeyframes.end());
+			inplace_merge(keyframes.begin(), keyframes.begin() + middle, keyframes.end(), keyframesort);
+			updateKeyframeSort();
+			timeline->flagTrackModified(this);
+		}
 
 //			if(timeline->getMovePlayheadOnPaste()){
 //				timeline->setCurrentTimeMillis( keyContainer[keyContainer.size()-1]->time );
 //			}
-		}
 	}
 }
 
@@ -666,6 +1505,7 @@ void ofxTLKeyframes::addKeyframeAtMillis(float value, unsigned long long millis)
 }
 
 void ofxTLKeyframes::selectAll(){
+	materializeAll();
 	selectedKeyframes = keyframes;
 }
 
@@ -687,6 +1527,13 @@ ofxTLKeyframe* ofxTLKeyframes::getKeyframeAtMillis( unsigned long long millis){
 
 
 unsigned long long ofxTLKeyframes::getEarliestTime(){
+	if(mappedKeys){
+		//the first mapped key, unless it's been copied out for editing
+		unsigned int first = mappedHiddenBegin == 0 ? mappedHiddenEnd : 0;
+		if(first < mappedKeys->numKeys && (keyframes.size() == 0 || mappedKeys->getTime(first) < keyframes[0]->time)){
+			return mappedKeys->getTime(first);
+		}
+	}
 	if(keyframes.size() > 0){
 		return keyframes[0]->time;
 	}
@@ -696,6 +1543,12 @@ unsigned long long ofxTLKeyframes::getEarliestTime(){
 }
 
 unsigned long long ofxTLKeyframes::getLatestTime(){
+	if(mappedKeys){
+		long long last = mappedHiddenEnd == mappedKeys->numKeys ? (long long)mappedHiddenBegin - 1 : mappedKeys->numKeys - 1;
+		if(last >= 0 && (keyframes.size() == 0 || mappedKeys->getTime(last) > keyframes[keyframes.size()-1]->time)){
+			return mappedKeys->getTime(last);
+		}
+	}
 	if(keyframes.size() > 0){
 		return keyframes[keyframes.size()-1]->time;
 	}
@@ -728,56 +1581,360 @@ string ofxTLKeyframes::getXMLRepresentation(){
 
 void ofxTLKeyframes::loadFromXMLRepresentation(string rep){
     clear();
-    ofxXmlSettings buffer;
-    buffer.loadFromBuffer(rep);
-    createKeyframesFromXML(buffer, keyframes);
+    createKeyframesFromXML(rep.data(), rep.size(), keyframes);
     updateKeyframeSort();
     timeline->flagUserChangedValue();    //because this is only called in Undo we don't flag track modified
 }
 
-//experimental binary saving. does not work with subclasses yet
-void ofxTLKeyframes::saveToBinaryFile(){
-	//write header
-	//# keyframes (int),
-	//size per keyframe (int)
-	//keyframe chain
-	string filePath = ofFilePath::removeExt(xmlFileName) + ".bin";
-
-	int numKeys = keyframes.size();
-	int keyBytes = sizeof(unsigned long long) + sizeof(float); //time + value
-	cout << "saving binary file " << filePath << " with # keys " << numKeys << endl;
-	ofFile outfile(ofToDataPath(filePath), ofFile::WriteOnly, true);
-	outfile.write((char*)&numKeys,sizeof(int));
-	outfile.write((char*)&keyBytes, sizeof(int));
-	for(int i = 0; i < keyframes.size(); i++){
-		outfile.write( (char*)&keyframes[i]->time, sizeof(unsigned long long));
-		outfile.write( (char*)&keyframes[i]->value, sizeof(float));
+//binary track files are a header followed by one key record per key:
+//"ofTL" [version] [byte order] [track type length][track type] [# keys] [payload size] [crc32 of payload]
+#define OFXTL_BINARY_MAGIC "ofTL"
+#define OFXTL_BINARY_VERSION 1
+#define OFXTL_BINARY_BYTE_ORDER 0x01020304
+
+string ofxTLKeyframes::getBinaryFileName(){
+	return ofFilePath::removeExt(xmlFileName) + ".bin";
+}
+
+string ofxTLKeyframes::getBinaryHeader(unsigned int numKeys, unsigned long long payloadSize, unsigned int checksum){
+	string header;
+	string trackType = getTrackType();
+	header.append(OFXTL_BINARY_MAGIC, 4);
+	appendBinary(header, (unsigned int)OFXTL_BINARY_VERSION);
+	appendBinary(header, (unsigned int)OFXTL_BINARY_BYTE_ORDER);
+	appendBinary(header, (unsigned int)trackType.size());
+	header.append(trackType);
+	appendBinary(header, numKeys);
+	appendBinary(header, payloadSize);
+	appendBinary(header, checksum);
+	return header;
+}
+
+bool ofxTLKeyframes::saveToBinaryFile(){
+	return writeBinaryFile(ofToDataPath(getBinaryFileName()), keyframes, mappedKeys.get(), mappedHiddenBegin, mappedHiddenEnd);
+}
+
+bool ofxTLKeyframes::writeBinaryFile(const string& filePath, vector<ofxTLKeyframe*>& keys, ofxTLMappedKeys* mapped, unsigned int hiddenBegin, unsigned int hiddenEnd){
+	//written next to the real file and moved over it once complete, so a failed
+	//save leaves the old one alone and a mapped track can keep reading it
+	string tempPath = filePath + ".tmp";
+	ofstream outfile(tempPath.c_str(), ios::out | ios::binary | ios::trunc);
+	if(!outfile.is_open()){
+		ofLogError("ofxTLKeyframes::writeBinaryFile") << "Couldn't open " << tempPath << " for writing";
+		return false;
+	}
+
+	//the header goes in again at the end once the size and checksum are known
+	string header = getBinaryHeader(0, 0, 0);
+	outfile.write(header.data(), header.size());
+
+	//mapped keys that haven't been edited are copied over as they are,
+	//merged in time order with the live ones
+	string payload;
+	unsigned long long payloadSize = 0;
+	unsigned int checksum = 0;
+	unsigned int numKeys = 0;
+	unsigned int mappedCount = mapped != NULL ? mapped->numKeys : 0;
+	unsigned int mappedIndex = 0;
+	int liveIndex = 0;
+	while(liveIndex < keys.size() || mappedIndex < mappedCount){
+		if(mappedIndex >= hiddenBegin && mappedIndex < hiddenEnd){
+			mappedIndex = hiddenEnd;
+			continue;
+		}
+		if(mappedIndex < mappedCount && (liveIndex == keys.size() || mapped->getTime(mappedIndex) < keys[liveIndex]->time)){
+			payload.append(mapped->getRecord(mappedIndex), mapped->getRecordStride());
+			mappedIndex++;
+		}
+		else if(!storeKeyRecord(keys[liveIndex++], payload)){
+			ofLogError("ofxTLKeyframes::writeBinaryFile") << getTrackType() << " track " << filePath << " has keys that can't be saved as binary";
+			outfile.close();
+			ofFile::removeFile(tempPath, false);
+			return false;
+		}
+		numKeys++;
+
+		//write as we go so huge tracks don't need a second copy in memory
+		if(payload.size() > 1024*1024){
+			checksum = ofxTLChecksum::crc32(payload.data(), payload.size(), checksum);
+			payloadSize += payload.size();
+			outfile.write(payload.data(), payload.size());
+			payload.clear();
+		}
 	}
+	checksum = ofxTLChecksum::crc32(payload.data(), payload.size(), checksum);
+	payloadSize += payload.size();
+	outfile.write(payload.data(), payload.size());
+
+	header = getBinaryHeader(numKeys, payloadSize, checksum);
+	outfile.seekp(0);
+	outfile.write(header.data(), header.size());
+	bool written = outfile.good();
 	outfile.close();
+	if(!written){
+		ofLogError("ofxTLKeyframes::writeBinaryFile") << "Couldn't write " << tempPath;
+		ofFile::removeFile(tempPath, false);
+		return false;
+	}
+	return ofxTLSaveJob::replaceFile(tempPath, filePath);
 }
 
-void ofxTLKeyframes::loadFromBinaryFile(){
+bool ofxTLKeyframes::loadFromBinaryFile(){
+	vector<ofxTLKeyframe*> keyContainer;
+	if(!readBinaryFile(getBinaryFileName(), keyContainer)){
+		return false;
+	}
 
-	string filePath = ofFilePath::removeExt(xmlFileName) + ".bin";
+	clear();
+	keyframes.swap(keyContainer);
+	shouldRecomputePreviews = true;
+	return true;
+}
 
+bool ofxTLKeyframes::readBinaryFile(const string& filePath, vector<ofxTLKeyframe*>& keyContainer){
 	if(!ofFile(filePath).exists()){
-		cout << "binary file doesn't exist " << filePath << endl;
-		return;
+		return false;
 	}
-	cout << " found file " << filePath << endl;
-	keyframes.clear();
-	ofFile infile(ofToDataPath(filePath), ofFile::ReadOnly, true);
-	int numKeys, keyBytes;
-	infile.read( (char*)&numKeys, sizeof(int) );
-	infile.read( (char*)&keyBytes, sizeof(int) );
-	cout << "# keys " << numKeys << " of size " << keyBytes << endl;
+
+	//one read for the whole file, then a single pass over it
+	ofBuffer buffer = ofBufferFromFile(filePath, true);
+	vector<ofxTLKeyframe*> keys;
+	if(!restoreBinaryTrack(buffer.getData(), buffer.size(), keys)){
+		for(int i = 0; i < keys.size(); i++){
+			delete keys[i];
+		}
+		return false;
+	}
+	keyContainer.insert(keyContainer.end(), keys.begin(), keys.end());
+	return true;
+}
+
+bool ofxTLKeyframes::restoreBinaryTrack(const char* data, size_t size, vector<ofxTLKeyframe*>& keyContainer){
+	const char* end = data + size;
+
+	//files from before the header was added are just [# keys][key size] then time and value for each key
+	if(size < 4 || memcmp(data, OFXTL_BINARY_MAGIC, 4) != 0){
+		int numKeys, keyBytes;
+		if(size < sizeof(int)*2){
+			ofLogError("ofxTLKeyframes::restoreBinaryTrack") << getBinaryFileName() << " is too short to be a track";
+			return false;
+		}
+		readBinary(data, numKeys);
+		readBinary(data, keyBytes);
+		if(numKeys < 0 || keyBytes != sizeof(unsigned long long) + sizeof(float) || end - data != (long long)numKeys * keyBytes){
+			ofLogError("ofxTLKeyframes::restoreBinaryTrack") << getBinaryFileName() << " isn't a track file";
+			return false;
+		}
+		keyContainer.reserve(numKeys);
+		for(int i = 0; i < numKeys; i++){
+			ofxTLKeyframe* key = newKeyframe();
+			readBinary(data, key->time);
+			key->previousTime = key->time;
+			readBinary(data, key->value);
+			keyContainer.push_back(key);
+		}
+		return true;
+	}
+
+	data += 4;
+	unsigned int numKeys, checksum;
+	unsigned long long payloadSize;
+	if(!readBinaryHeader(data, end, numKeys, payloadSize, checksum)){
+		return false;
+	}
+	if(ofxTLChecksum::crc32(data, payloadSize) != checksum){
+		ofLogError("ofxTLKeyframes::restoreBinaryTrack") << getBinaryFileName() << " is damaged, checksum doesn't match";
+		return false;
+	}
+
+	keyContainer.reserve(numKeys);
 	for(int i = 0; i < numKeys; i++){
-		ofxTLKeyframe* k = newKeyframe();
-		infile.read( (char*)&k->time, sizeof(unsigned long long) );
-		infile.read( (char*)&k->value, sizeof(float) );
-		keyframes.push_back(k);
+		unsigned int recordSize;
+		if(end - data < sizeof(recordSize)){
+			ofLogError("ofxTLKeyframes::restoreBinaryTrack") << getBinaryFileName() << " has fewer keys than it says";
+			return false;
+		}
+		memcpy(&recordSize, data, sizeof(recordSize));
+		if(end - data - sizeof(recordSize) < recordSize){
+			ofLogError("ofxTLKeyframes::restoreBinaryTrack") << getBinaryFileName() << " has a broken key record";
+			return false;
+		}
+		ofxTLKeyframe* key = newKeyframe();
+		restoreKeyRecord(key, data);
+		keyContainer.push_back(key);
+		data += sizeof(recordSize) + recordSize;
+	}
+	return true;
+}
+
+bool ofxTLKeyframes::readBinaryHeader(const char*& data, const char* end, unsigned int& numKeys, unsigned long long& payloadSize, unsigned int& checksum){
+	unsigned int version, byteOrder, typeLength;
+	if(end - data < sizeof(unsigned int)*3){
+		ofLogError("ofxTLKeyframes::readBinaryHeader") << getBinaryFileName() << " is truncated";
+		return false;
+	}
+	readBinary(data, version);
+	readBinary(data, byteOrder);
+	readBinary(data, typeLength);
+	if(byteOrder != OFXTL_BINARY_BYTE_ORDER){
+		ofLogError("ofxTLKeyframes::readBinaryHeader") << getBinaryFileName() << " was saved on a machine with a different byte order";
+		return false;
+	}
+	if(version > OFXTL_BINARY_VERSION){
+		ofLogError("ofxTLKeyframes::readBinaryHeader") << getBinaryFileName() << " was saved by a newer version (" << version << ")";
+		return false;
+	}
+
+	if(end - data < typeLength + sizeof(unsigned int)*2 + sizeof(unsigned long long)){
+		ofLogError("ofxTLKeyframes::readBinaryHeader") << getBinaryFileName() << " is truncated";
+		return false;
+	}
+	string trackType(data, typeLength);
+	data += typeLength;
+	if(trackType != getTrackType()){
+		ofLogError("ofxTLKeyframes::readBinaryHeader") << getBinaryFileName() << " holds a " << trackType << " track, not " << getTrackType();
+		return false;
+	}
+	readBinary(data, numKeys);
+	readBinary(data, payloadSize);
+	readBinary(data, checksum);
+	if(end - data != payloadSize){
+		ofLogError("ofxTLKeyframes::readBinaryHeader") << getBinaryFileName() << " is truncated";
+		return false;
+	}
+	return true;
+}
+
+bool ofxTLKeyframes::canMapBinaryFile(){
+	return typeid(*this) == typeid(ofxTLKeyframes);
+}
+
+bool ofxTLKeyframes::isMapped(){
+	return mappedKeys.get() != NULL;
+}
+
+bool ofxTLKeyframes::mapBinaryFile(){
+	if(!canMapBinaryFile() || !ofFile(getBinaryFileName()).exists()){
+		return false;
+	}
+
+	ofxTLMappedFile* file = new ofxTLMappedFile();
+	if(!file->open(ofToDataPath(getBinaryFileName()))){
+		delete file;
+		return false;
+	}
+
+	//anything that can't be read in place, like headerless files, is left to loadFromBinaryFile.
+	//the checksum isn't checked here, that would mean reading the whole file
+	const char* data = file->getData();
+	const char* end = data + file->size();
+	unsigned int numKeys, checksum, recordSize;
+	unsigned long long payloadSize;
+	if(file->size() < 4 || memcmp(data, OFXTL_BINARY_MAGIC, 4) != 0){
+		delete file;
+		return false;
+	}
+	data += 4;
+	if(!readBinaryHeader(data, end, numKeys, payloadSize, checksum) || numKeys == 0 || payloadSize < sizeof(recordSize)){
+		delete file;
+		return false;
+	}
+	memcpy(&recordSize, data, sizeof(recordSize));
+	unsigned long long recordStride = sizeof(recordSize) + recordSize;
+	if(recordSize < sizeof(unsigned long long) + sizeof(float) || recordStride * numKeys != payloadSize ||
+	   memcmp(data, data + recordStride * (numKeys-1), sizeof(recordSize)) != 0)
+	{
+		ofLogNotice("ofxTLKeyframes::mapBinaryFile") << getBinaryFileName() << " has keys of different sizes, loading it normally";
+		delete file;
+		return false;
+	}
+
+	ofxTLKeyframe* prototype = newKeyframe();
+	ofxTLKeyframe* copy = copyKeyframe(prototype);
+	if(copy == NULL){
+		delete prototype;
+		delete file;
+		return false;
+	}
+	delete copy;
+	//every record is read into a key of this type, so each one has to be exactly as big
+	//as this type stores. that keeps restoreKeyframeBinary inside the record it was given
+	string prototypeRecord;
+	if(!storeKeyRecord(prototype, prototypeRecord) || prototypeRecord.size() != recordStride){
+		ofLogNotice("ofxTLKeyframes::mapBinaryFile") << getBinaryFileName() << " has keys of another size than " << getTrackType() << " stores, loading it normally";
+		delete prototype;
+		delete file;
+		return false;
+	}
+
+	clear();
+	mappedKeys = std::shared_ptr<ofxTLMappedKeys>(new ofxTLMappedKeys(file, data, numKeys, recordStride, prototype));
+	if(mappedKeys->getTime(numKeys-1) > timeline->getDurationInMilliseconds()){
+		timeline->setDurationInMillis(mappedKeys->getTime(numKeys-1));
 	}
 	shouldRecomputePreviews = true;
+	return true;
+}
+
+void ofxTLKeyframes::materializeRange(unsigned long long startMillis, unsigned long long endMillis){
+	if(!mappedKeys){
+		return;
+	}
+	unsigned int begin = startMillis == 0 ? 0 : mappedKeys->upperBound(startMillis-1);
+	unsigned int end = mappedKeys->upperBound(endMillis);
+	materializeMappedKeys(begin, end);
+}
+
+void ofxTLKeyframes::materializeAll(){
+	if(mappedKeys){
+		materializeMappedKeys(0, mappedKeys->numKeys);
+	}
+}
+
+void ofxTLKeyframes::loadEditorData(){
+	materializeAll();
+}
+
+void ofxTLKeyframes::materializeMappedKeys(unsigned int begin, unsigned int end){
+	//the copied out part stays in one piece, so anything between it and the new range comes too
+	unsigned int hiddenBegin = mappedHiddenBegin;
+	unsigned int hiddenEnd = mappedHiddenEnd;
+	if(hiddenBegin == hiddenEnd){
+		if(begin >= end){
+			return;
+		}
+		hiddenBegin = hiddenEnd = begin;
+	}
+	else{
+		begin = MIN(begin, hiddenBegin);
+		end = MAX(end, hiddenEnd);
+	}
+	if(begin == hiddenBegin && end == hiddenEnd){
+		return;
+	}
+
+	keyframes.reserve(keyframes.size() + (hiddenBegin - begin) + (end - hiddenEnd));
+	for(unsigned int i = begin; i < end; i++){
+		if(i == hiddenBegin){
+			i = hiddenEnd;
+			if(i == end){
+				break;
+			}
+		}
+		ofxTLKeyframe* key = newKeyframe();
+		restoreKeyRecord(key, mappedKeys->getRecord(i));
+		keyframes.push_back(key);
+	}
+	mappedHiddenBegin = begin;
+	mappedHiddenEnd = end;
+
+	//once everything is editable the file isn't needed anymore.
+	//snapshots still reading it keep it open until they're freed
+	if(begin == 0 && end == mappedKeys->numKeys){
+		mappedKeys.reset();
+		mappedHiddenBegin = mappedHiddenEnd = 0;
+	}
+	updateKeyframeSort();
 }
 
 void ofxTLKeyframes::keyPressed(ofKeyEventArgs& args){
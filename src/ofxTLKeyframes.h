@@ -36,19 +36,135 @@
 #include "ofRange.h"
 #include "ofxTLTrack.h"
 #include "ofxXmlSettings.h"
+#include "ofxTLMappedFile.h"
+#include "ofxTLXMLKeyReader.h"
+#include "ofxTLSerialization.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <typeinfo>
+#include <cstring>
 
 class ofxTLKeyframe {
   public:
+	ofxTLKeyframe() : undoId(0) {};
+	virtual ~ofxTLKeyframe(){};
 	ofVec2f screenPosition; // cached screen position
 	unsigned long long previousTime; //for preventing overlap conflicts
     unsigned long long time; //in millis
     float value; //normalized
     long grabTimeOffset;
     float grabValueOffset;
+	unsigned int undoId; //stays with the key across undo and redo, 0 until first needed
+};
+
+//the keys of a binary track file read straight out of the mapped file.
+//every record has to be the same size so any key can be found without reading the ones before it
+class ofxTLMappedKeys {
+  public:
+	ofxTLMappedKeys(ofxTLMappedFile* file, const char* records, unsigned int numKeys, unsigned int recordStride, ofxTLKeyframe* prototype);
+	~ofxTLMappedKeys();
+
+	unsigned long long getTime(unsigned int index);
+	const char* getRecord(unsigned int index);
+	unsigned int getRecordStride();
+	//index of the first key after time, numKeys if there isn't one
+	unsigned int upperBound(unsigned long long time);
+
+	unsigned int numKeys;
+	ofxTLKeyframe* prototype; //copied to make a key to read each record into
+
+  protected:
+	ofxTLMappedFile* file;
+	const char* records;
+	unsigned int recordStride;
+};
+
+//read only copy of a track's keyframes, sorted by time.
+//this is what playback samples from so edits never touch it,
+//undo also holds on to it as the state before an action, and autosave as what to write
+class ofxTLKeyframeSnapshot {
+  public:
+	ofxTLKeyframeSnapshot() : holds(0), mappedHiddenBegin(0), mappedHiddenEnd(0), copiedThroughRecords(false) {};
+	~ofxTLKeyframeSnapshot();
+	vector<ofxTLKeyframe*> keyframes;
+	//undo, autosave and the journal can hold a snapshot from different threads
+	std::atomic<int> holds;
+	//mapped keys between these indices have been copied into keyframes for editing
+	std::shared_ptr<ofxTLMappedKeys> mappedKeys;
+	unsigned int mappedHiddenBegin;
+	unsigned int mappedHiddenEnd;
+	//some keys needed newKeyframe() to be copied, see copyKeyframeThroughRecord
+	bool copiedThroughRecords;
+	//for keys that span a range, the latest end of each key and all the ones before it
+	vector<unsigned long long> rangeEnds;
+};
+
+class ofxTLKeyframes;
+
+//records only the keys that were added, removed or changed by an action,
+//each one as a small binary record tagged with the key's undoId.
+//the starting state is the playback snapshot, which is shared rather than
+//copied, so nothing is stored until finish() finds the track really changed
+class ofxTLKeyframesUndoDelta : public ofxTLUndoDelta {
+  public:
+	ofxTLKeyframesUndoDelta(ofxTLKeyframes* track, ofxTLKeyframeSnapshot* startSnapshot);
+	//for keys that can't be snapshotted, starts from records of every key
+	ofxTLKeyframesUndoDelta(ofxTLKeyframes* track, string& startRecords);
+	virtual ~ofxTLKeyframesUndoDelta();
+
+	virtual void finish();
+	virtual void undo();
+	virtual void redo();
+
+  protected:
+	//before and after hold records of the changed keys
+	ofxTLKeyframes* keyframesTrack;
+	ofxTLKeyframeSnapshot* startSnapshot;
+};
+
+//autosave of a held snapshot. binary if the track saves that way, xml otherwise
+class ofxTLKeyframesSaveJob : public ofxTLSaveJob {
+  public:
+	ofxTLKeyframesSaveJob(ofxTLKeyframes* track, ofxTLKeyframeSnapshot* snapshot);
+	virtual ~ofxTLKeyframesSaveJob();
+
+	virtual bool write();
+
+  protected:
+	ofxTLKeyframes* keyframesTrack;
+	ofxTLKeyframeSnapshot* snapshot;
+	bool useBinary;
+	string binaryPath;
+	string xmlPath;
+};
+
+//reads the track's binary or xml file into keys of its own, see canLoadInBackground
+class ofxTLKeyframesLoadJob : public ofxTLLoadJob {
+  public:
+	ofxTLKeyframesLoadJob(ofxTLKeyframes* track);
+	virtual ~ofxTLKeyframesLoadJob();
+
+	virtual void read();
+	virtual void finish();
+
+  protected:
+	ofxTLKeyframes* keyframesTrack;
+	vector<ofxTLKeyframe*> keys;
+	bool useBinary;
+	bool useMapped;
+	bool readInBackground;
+	bool loaded;
+	string binaryPath;
+	string xmlPath;
 };
 
 class ofxTLKeyframes : public ofxTLTrack
 {
+  friend class ofxTLKeyframesUndoDelta;
+  friend class ofxTLKeyframesSaveJob;
+  friend class ofxTLKeyframesLoadJob;
+
   public:
 	ofxTLKeyframes();
 	virtual ~ofxTLKeyframes();
@@ -65,9 +181,12 @@ class ofxTLKeyframes : public ofxTLTrack
 	virtual void keyPressed(ofKeyEventArgs& args);
 
 	virtual void getSnappingPoints(std::set<unsigned long long>& points);
+	virtual bool updateSnapIndex(vector<unsigned long long>& index);
+	virtual void getSelectedSnappingPoints(vector<unsigned long long>& points);
 
 	virtual void save();
 	virtual void load();
+	virtual ofxTLLoadJob* beginBackgroundLoad();
 
 	virtual void clear();
 
@@ -97,6 +216,15 @@ class ofxTLKeyframes : public ofxTLTrack
     //undo
     virtual string getXMLRepresentation();
     virtual void loadFromXMLRepresentation(string rep);
+	//uses binary deltas when every key can be stored with storeKeyframeBinary
+	virtual ofxTLUndoDelta* beginUndoDelta();
+	//autosave writes from the playback snapshot, so only works for keys that can be copied
+	virtual ofxTLSaveJob* beginBackgroundSave();
+	//the journal records keys that changed between two playback snapshots as undo records.
+	//mapped tracks are saved whole since their keys aren't in the snapshot
+	virtual bool startJournal();
+	virtual bool storeJournalChanges(string& removed, string& written);
+	virtual bool replayJournalChanges(const string& removed, const string& written);
 
     virtual void regionSelected(ofLongRange timeRange, ofRange valueRange);
 
@@ -116,14 +244,58 @@ class ofxTLKeyframes : public ofxTLTrack
 
     virtual ofRange getValueRange();
 
-	//experimental binary saving. does not work with subclasses yet
-	void saveToBinaryFile();
-	void loadFromBinaryFile();
+	//binary saving, much faster than xml for big tracks. keys go through
+	//storeKeyframeBinary so subclass data is kept. these return false when the
+	//track can't be written or the file can't be read, save() and load() then use xml
+	bool saveToBinaryFile();
+	bool loadFromBinaryFile();
+	//reads the binary file if useBinary is set and it's there, otherwise the xml one.
+	//returns false if neither could be read
+	bool readKeyframeFiles(const string& binaryPath, const string& xmlPath, bool useBinary, vector<ofxTLKeyframe*>& keyContainer);
+	bool readBinaryFile(const string& filePath, vector<ofxTLKeyframe*>& keyContainer);
+	string getBinaryFileName();
 	bool useBinarySave;
 
+	//with useMappedLoad big binary tracks are mapped into memory instead of loaded.
+	//playback samples the file directly and keys only become editable once
+	//the part of the track they are in gets clicked or selected
+	bool useMappedLoad;
+	bool isMapped();
+	//turns the mapped keys in this range into ordinary keyframes
+	void materializeRange(unsigned long long startMillis, unsigned long long endMillis);
+	void materializeAll();
+	//materializes everything, see ofxTimeline::setLazyPageLoading
+	virtual void loadEditorData();
+
+	//pushes the current keyframes to the playback side
+	virtual void publishChanges();
+
   protected:
 	virtual ofxTLKeyframe* newKeyframe();
+	//make a copy of the key for the playback snapshot. return NULL for
+	//types you don't know how to copy and the key is copied through its
+	//binary record instead. only keys storeKeyframeBinary can't write either
+	//leave playback reading the live keyframes
+	virtual ofxTLKeyframe* copyKeyframe(ofxTLKeyframe* key);
+	ofxTLKeyframe* copyKeyframeThroughRecord(ofxTLKeyframe* key);
 	vector<ofxTLKeyframe*> keyframes;
+	//for searching the sorted keys with lower_bound
+	static bool keyframeIsBeforeTime(ofxTLKeyframe* key, unsigned long long time);
+
+	//playback reads through begin/endPlaybackRead and never locks.
+	//edits swap in a new snapshot and the old one is freed once no reader is left
+	vector<ofxTLKeyframe*>& beginPlaybackRead();
+	vector<ofxTLKeyframe*>& beginPlaybackRead(ofxTLKeyframeSnapshot*& snapshot);
+	void endPlaybackRead();
+	void publishKeyframes();
+	//called on every new snapshot once its keys are sorted
+	virtual void indexPlaybackKeys(ofxTLKeyframeSnapshot* snapshot){};
+	std::atomic<ofxTLKeyframeSnapshot*> playbackSnapshot;
+	std::atomic<int> playbackReaders;
+	vector<ofxTLKeyframeSnapshot*> retiredSnapshots;
+	//guards retiredSnapshots, and taking a hold so a snapshot can't be retired and freed in between
+	std::mutex snapshotLock;
+	bool warnedLivePlayback;
 
 	//cached previews for fast drawing of large timelines
 	ofPolyline preview;
@@ -136,13 +308,26 @@ class ofxTLKeyframes : public ofxTLTrack
     virtual float sampleAtTime(long sampleTime);
 	virtual float interpolateValueForKeys(ofxTLKeyframe* start,ofxTLKeyframe* end, unsigned long long sampleTime);
 	virtual float evaluateKeyframeAtTime(ofxTLKeyframe* key, unsigned long long sampleTime, bool firstKey = false);
+	float sampleMappedAtTime(ofxTLKeyframeSnapshot* snapshot, unsigned long long sampleTime);
+
+	//only tracks that play back through sampleAtTime and whose restoreKeyframeBinary
+	//has no side effects can be sampled from a mapped file
+	virtual bool canMapBinaryFile();
+	//tracks whose keys can be created and restored without touching the track or timeline
+	//are read on worker threads when loading a folder, the rest are read from the main thread
+	virtual bool canLoadInBackground();
+	virtual bool canRenderInParallel();
+	bool mapBinaryFile();
+	void materializeMappedKeys(unsigned int begin, unsigned int end);
+	std::shared_ptr<ofxTLMappedKeys> mappedKeys;
+	unsigned int mappedHiddenBegin;
+	unsigned int mappedHiddenEnd;
 
     ofRange valueRange;
 	float defaultValue;
 
-	//keep these stored for efficient search through the keyframe array
-	int lastKeyframeIndex;
-	unsigned long long lastSampleTime;
+	//keep this stored for efficient search through the keyframe array
+	std::atomic<int> lastKeyframeIndex;
 
     virtual ofxTLKeyframe* keyframeAtScreenpoint(ofVec2f p);
 	bool isKeyframeIsInBounds(ofxTLKeyframe* key);
@@ -173,9 +358,64 @@ class ofxTLKeyframes : public ofxTLTrack
 	virtual void updateDragOffsets(ofVec2f screenpoint, long grabMillis);
 
 	virtual string getXMLStringForKeyframes(vector<ofxTLKeyframe*>& keys);
+	//copies are the keys as key records behind a short header naming the track type,
+	//or xml if any of them can't be stored as binary. the keys have to be sorted
+	string getClipboardForKeyframes(vector<ofxTLKeyframe*>& keys);
+	//returns false if it isn't a binary clipboard, xml from older versions and other apps is pasted as before.
+	//keys copied from a different type of track only keep their time and value
+	bool createKeyframesFromClipboard(const string& clipboard, vector<ofxTLKeyframe*>& keyContainer);
 	virtual void createKeyframesFromXML(ofxXmlSettings xml, vector<ofxTLKeyframe*>& keyContainer);
+	//reads the xml in one pass without loading it into ofxXmlSettings first
+	void createKeyframesFromXML(const char* xml, size_t length, vector<ofxTLKeyframe*>& keyContainer);
+	//restore custom properties from the key's tags. the default hands restoreKeyframe
+	//an ofxXmlSettings of just the key, override this instead for big tracks
+	virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
 	virtual void restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){};
     virtual void storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){};
+	//binary versions of the above for undo. time and value are already taken care of,
+	//append whatever else your keyframe has and return false for types you don't know
+	virtual bool storeKeyframeBinary(ofxTLKeyframe* key, string& buffer);
+	virtual void restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){};
+	//keys pasted from another type of track only bring their time and value, fill in the rest here
+	virtual void restorePastedKeyframe(ofxTLKeyframe* key){};
+
+	template<typename T> static void appendBinary(string& buffer, const T& value){
+		ofxTLSerialization::appendValue(buffer, value);
+	}
+	template<typename T> static void readBinary(const char*& buffer, T& value){
+		memcpy(&value, buffer, sizeof(T));
+		buffer += sizeof(T);
+	}
+
+	//a key record is [payload size][time][value][storeKeyframeBinary data],
+	//used by both undo and binary files
+	bool storeKeyRecord(ofxTLKeyframe* key, string& buffer);
+	void restoreKeyRecord(ofxTLKeyframe* key, const char* record);
+	//parses a whole binary track file, checking the header and checksum
+	bool restoreBinaryTrack(const char* data, size_t size, vector<ofxTLKeyframe*>& keyContainer);
+	//checks everything after the magic and leaves data at the start of the payload
+	bool readBinaryHeader(const char*& data, const char* end, unsigned int& numKeys, unsigned long long& payloadSize, unsigned int& checksum);
+	string getBinaryHeader(unsigned int numKeys, unsigned long long payloadSize, unsigned int checksum);
+	//the file writing behind saving, kept apart from the live track so autosave can
+	//use them with a snapshot. the keys have to be sorted
+	bool writeBinaryFile(const string& filePath, vector<ofxTLKeyframe*>& keys, ofxTLMappedKeys* mapped, unsigned int hiddenBegin, unsigned int hiddenEnd);
+	bool writeXMLFile(const string& filePath, vector<ofxTLKeyframe*>& keys);
+
+	//writes every key as an undo record, returns false if any of them can't be stored
+	bool storeUndoRecords(string& buffer);
+	bool storeUndoRecords(vector<ofxTLKeyframe*>& keys, string& buffer);
+	//keeps the current playback snapshot around for undo, NULL if there isn't one
+	ofxTLKeyframeSnapshot* holdSnapshot();
+	void releaseSnapshot(ofxTLKeyframeSnapshot* snapshot);
+	//deletes the keys in removed that aren't in written, then creates or overwrites the written ones
+	virtual void restoreUndoRecords(const string& removed, const string& written);
+	unsigned int lastUndoId;
+	//the state the track's file was last known to be in
+	ofxTLKeyframeSnapshot* journalSnapshot;
+	//journalSnapshot's keys as undo records
+	string journalRecords;
+	//a key among the first count whose record matches, undoIds don't last past a restart
+	ofxTLKeyframe* findKeyForRecord(const char* record, int count, std::set<ofxTLKeyframe*>& skip);
 
     virtual void selectedKeySecondaryClick(ofMouseEventArgs& args){};
 
@@ -126,6 +126,7 @@ void ofxTLLFO::draw(){
 	}
 	
 	if(shouldRecomputePreviews || viewIsDirty){
+		OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_PREVIEWS);
 		recomputePreviews();
 	}
 	
@@ -328,6 +329,7 @@ void ofxTLLFO::mouseDragged(ofMouseEventArgs& args, long millis){
 			shouldRecomputePreviews = true;
 			draggedValue = true;
 			timeline->flagUserChangedValue();
+			markChanged();
 		}
 	}
 	else{
@@ -411,16 +413,39 @@ ofxTLKeyframe* ofxTLLFO::newKeyframe(){
 	return newKey;
 }
 
-void ofxTLLFO::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
+ofxTLKeyframe* ofxTLLFO::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLLFOKey)){
+		return new ofxTLLFOKey(*(ofxTLLFOKey*)key);
+	}
+	return NULL;
+}
+
+bool ofxTLLFO::canMapBinaryFile(){
+	return typeid(*this) == typeid(ofxTLLFO);
+}
+
+bool ofxTLLFO::canLoadInBackground(){
+	return typeid(*this) == typeid(ofxTLLFO);
+}
+
+bool ofxTLLFO::canRenderInParallel(){
+	return typeid(*this) == typeid(ofxTLLFO);
+}
+
+void ofxTLLFO::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
 	ofxTLLFOKey* lfoKey = (ofxTLLFOKey*)key;
-	lfoKey->type = (ofxTLLFOType)xmlStore.getValue("type", int(OFXTL_LFO_TYPE_NOISE));
-	lfoKey->phaseShift = xmlStore.getValue("phaseShift", 0.);
-	lfoKey->amplitude = xmlStore.getValue("amplitude", 1.);
-	lfoKey->frequency = xmlStore.getValue("frequency", 100.);
-	lfoKey->seed = xmlStore.getValue("seed", 0.);
-	lfoKey->center = xmlStore.getValue("center", 0.);
-	lfoKey->interpolate = xmlStore.getValue("interpolate", true);
-	lfoKey->expInterpolate = xmlStore.getValue("expInterpolate", true);
+	lfoKey->type = (ofxTLLFOType)ofClamp(keyTags.getValue("type", int(OFXTL_LFO_TYPE_NOISE)), OFXTL_LFO_TYPE_SINE, OFXTL_LFO_TYPE_NOISE);
+	lfoKey->phaseShift = keyTags.getValue("phaseShift", 0.);
+	lfoKey->amplitude = keyTags.getValue("amplitude", 1.);
+	lfoKey->frequency = keyTags.getValue("frequency", 100.);
+	lfoKey->seed = keyTags.getValue("seed", 0.);
+	lfoKey->center = keyTags.getValue("center", 0.);
+	lfoKey->interpolate = keyTags.getValue("interpolate", true);
+	lfoKey->expInterpolate = keyTags.getValue("expInterpolate", true);
+	//subclasses that read their own tags in restoreKeyframe still get them
+	if(typeid(*this) != typeid(ofxTLLFO)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
 }
 
 void ofxTLLFO::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
@@ -436,6 +461,41 @@ void ofxTLLFO::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
 	xmlStore.addValue("expInterpolate",lfoKey->expInterpolate);
 }
 
+bool ofxTLLFO::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	if(typeid(*key) != typeid(ofxTLLFOKey)){
+		return false;
+	}
+	ofxTLLFOKey* lfoKey = (ofxTLLFOKey*)key;
+	appendBinary(buffer, int(lfoKey->type));
+	appendBinary(buffer, lfoKey->phaseShift);
+	appendBinary(buffer, lfoKey->phaseMatch);
+	appendBinary(buffer, lfoKey->amplitude);
+	appendBinary(buffer, lfoKey->frequency);
+	appendBinary(buffer, lfoKey->seed);
+	appendBinary(buffer, lfoKey->center);
+	appendBinary(buffer, lfoKey->freqDeviation);
+	appendBinary(buffer, lfoKey->interpolate);
+	appendBinary(buffer, lfoKey->expInterpolate);
+	return true;
+}
+
+void ofxTLLFO::restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){
+	ofxTLLFOKey* lfoKey = (ofxTLLFOKey*)key;
+	int type;
+	readBinary(buffer, type);
+	//a damaged file can't make a type the sampling doesn't know
+	lfoKey->type = (ofxTLLFOType)ofClamp(type, OFXTL_LFO_TYPE_SINE, OFXTL_LFO_TYPE_NOISE);
+	readBinary(buffer, lfoKey->phaseShift);
+	readBinary(buffer, lfoKey->phaseMatch);
+	readBinary(buffer, lfoKey->amplitude);
+	readBinary(buffer, lfoKey->frequency);
+	readBinary(buffer, lfoKey->seed);
+	readBinary(buffer, lfoKey->center);
+	readBinary(buffer, lfoKey->freqDeviation);
+	readBinary(buffer, lfoKey->interpolate);
+	readBinary(buffer, lfoKey->expInterpolate);
+}
+
 void ofxTLLFO::selectedKeySecondaryClick(ofMouseEventArgs& args){
 	drawingLFORect = true;
 	lfoRect = ofRectangle(args.x,args.y, 40,40);
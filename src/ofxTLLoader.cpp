@@ -0,0 +1,147 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLLoader.h"
+#include "ofxTLProfiler.h"
+
+ofxTLLoadJob::ofxTLLoadJob(ofxTLTrack* track)
+:	track(track)
+{
+
+}
+
+ofxTLTrack* ofxTLLoadJob::getTrack(){
+	return track;
+}
+
+ofxTLLoader::ofxTLLoader()
+:	numFinished(0),
+	numJobs(0)
+{
+
+}
+
+ofxTLLoader::~ofxTLLoader(){
+	wait();
+}
+
+void ofxTLLoader::start(vector<ofxTLLoadJob*>& newJobs, int numThreads){
+	//one load at a time
+	wait();
+	jobs = newJobs;
+	numFinished = 0;
+	numJobs = jobs.size();
+	for(int i = 0; i < jobs.size(); i++){
+		loadingTracks.insert(jobs[i]->getTrack());
+	}
+	if(jobs.size() > 0){
+		reader = std::thread(&ofxTLLoader::readJobs, this, numThreads);
+	}
+}
+
+void ofxTLLoader::readJobs(int numThreads){
+	pool.setup(numThreads);
+	pool.parallelFor(jobs.size(), [this](int i){
+		{
+			OFXTL_PROFILE_SCOPE(jobs[i]->getTrack(), OFXTL_PROFILE_LOAD);
+			jobs[i]->read();
+		}
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			readJobIndices.push_back(i);
+		}
+		jobRead.notify_one();
+	});
+	pool.shutdown();
+}
+
+int ofxTLLoader::update(){
+	vector<int> ready;
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		ready.swap(readJobIndices);
+	}
+	for(int i = 0; i < ready.size(); i++){
+		ofxTLLoadJob* job = jobs[ready[i]];
+		//finishing can cause a save, which shouldn't be held back as if still loading
+		loadingTracks.erase(job->getTrack());
+		OFXTL_PROFILE_SCOPE(job->getTrack(), OFXTL_PROFILE_LOAD);
+		job->finish();
+		numFinished++;
+	}
+	if(isLoading() && numFinished == numJobs){
+		end();
+	}
+	return ready.size();
+}
+
+void ofxTLLoader::wait(){
+	while(isLoading()){
+		waitForRead();
+		update();
+	}
+}
+
+void ofxTLLoader::waitForRead(){
+	if(!isLoading()){
+		return;
+	}
+	std::unique_lock<std::mutex> guard(lock);
+	jobRead.wait(guard, [this]{ return !readJobIndices.empty(); });
+}
+
+void ofxTLLoader::end(){
+	if(reader.joinable()){
+		reader.join();
+	}
+	for(int i = 0; i < jobs.size(); i++){
+		delete jobs[i];
+	}
+	jobs.clear();
+	loadingTracks.clear();
+}
+
+bool ofxTLLoader::isLoading(){
+	return jobs.size() > 0;
+}
+
+bool ofxTLLoader::isLoading(ofxTLTrack* track){
+	return loadingTracks.find(track) != loadingTracks.end();
+}
+
+int ofxTLLoader::getNumFinished(){
+	return numFinished;
+}
+
+int ofxTLLoader::getNumJobs(){
+	return numJobs;
+}
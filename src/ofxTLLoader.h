@@ -0,0 +1,98 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxTLWorkerPool.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+
+class ofxTLTrack;
+
+//a load of one track split in two: read() parses the file into something the track
+//doesn't see yet and can run on any thread, finish() hands it over on the main thread
+class ofxTLLoadJob {
+  public:
+	ofxTLLoadJob(ofxTLTrack* track);
+	virtual ~ofxTLLoadJob(){};
+
+	virtual void read() = 0;
+	virtual void finish() = 0;
+
+	ofxTLTrack* getTrack();
+
+  protected:
+	ofxTLTrack* track;
+};
+
+//reads load jobs on a pool of worker threads while the app keeps running.
+//jobs are finished from update() in whatever order they come in
+class ofxTLLoader {
+  public:
+	ofxTLLoader();
+	virtual ~ofxTLLoader();
+
+	//takes ownership of the jobs and returns right away. 0 threads uses one less than the hardware has
+	void start(vector<ofxTLLoadJob*>& jobs, int numThreads = 0);
+	//finishes the jobs that have been read, call from the main thread.
+	//returns the number finished this time
+	int update();
+	//blocks until every job is read and finished
+	void wait();
+	//blocks until there's something for update() to finish or nothing is loading
+	void waitForRead();
+
+	bool isLoading();
+	//true while the track's job hasn't been finished
+	bool isLoading(ofxTLTrack* track);
+	//counts for the last load, they stay around after it's done
+	int getNumFinished();
+	int getNumJobs();
+
+  protected:
+	void readJobs(int numThreads);
+	void end();
+
+	vector<ofxTLLoadJob*> jobs;
+	std::set<ofxTLTrack*> loadingTracks;
+	int numFinished;
+	int numJobs;
+
+	ofxTLWorkerPool pool;
+	std::thread reader;
+	std::mutex lock;
+	std::condition_variable jobRead;
+	vector<int> readJobIndices; //read but not finished
+};
@@ -0,0 +1,146 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLMappedFile.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+ofxTLMappedFile::ofxTLMappedFile()
+:	data(NULL),
+	length(0),
+#ifdef TARGET_WIN32
+	fileHandle(INVALID_HANDLE_VALUE),
+	mappingHandle(NULL)
+#else
+	fileDescriptor(-1)
+#endif
+{
+
+}
+
+ofxTLMappedFile::~ofxTLMappedFile(){
+	close();
+}
+
+bool ofxTLMappedFile::open(string path){
+	close();
+#ifdef TARGET_WIN32
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(fileHandle == INVALID_HANDLE_VALUE){
+		ofLogError("ofxTLMappedFile::open") << "Couldn't open " << path;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0){
+		close();
+		return false;
+	}
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(mappingHandle == NULL){
+		ofLogError("ofxTLMappedFile::open") << "Couldn't map " << path;
+		close();
+		return false;
+	}
+	data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if(data == NULL){
+		ofLogError("ofxTLMappedFile::open") << "Couldn't map " << path;
+		close();
+		return false;
+	}
+	length = fileSize.QuadPart;
+#else
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if(fileDescriptor < 0){
+		ofLogError("ofxTLMappedFile::open") << "Couldn't open " << path;
+		return false;
+	}
+	struct stat fileInfo;
+	if(fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0){
+		close();
+		return false;
+	}
+	void* mapped = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	if(mapped == MAP_FAILED){
+		ofLogError("ofxTLMappedFile::open") << "Couldn't map " << path;
+		close();
+		return false;
+	}
+	data = (const char*)mapped;
+	length = fileInfo.st_size;
+#endif
+	return true;
+}
+
+void ofxTLMappedFile::close(){
+#ifdef TARGET_WIN32
+	if(data != NULL){
+		UnmapViewOfFile(data);
+	}
+	if(mappingHandle != NULL){
+		CloseHandle(mappingHandle);
+		mappingHandle = NULL;
+	}
+	if(fileHandle != INVALID_HANDLE_VALUE){
+		CloseHandle(fileHandle);
+		fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if(data != NULL){
+		munmap((void*)data, length);
+	}
+	if(fileDescriptor >= 0){
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+#endif
+	data = NULL;
+	length = 0;
+}
+
+bool ofxTLMappedFile::isOpen(){
+	return data != NULL;
+}
+
+const char* ofxTLMappedFile::getData(){
+	return data;
+}
+
+size_t ofxTLMappedFile::size(){
+	return length;
+}
@@ -59,42 +59,76 @@ ofxTLNote::ofxTLNote(){
 ofxTLNotes::ofxTLNotes(){
 	placingSwitch = NULL;
     oneArgMode = false;
+    stopGrowing = false;
     valueRange = ofRange(0,NUM_NOTES-1);
 
     _activeNotes = new vector<float>();
     _activeNotes->assign(NUM_NOTES,0.0f);
+    ofAddListener(ofEvents().update, this, &ofxTLNotes::growNotes);
 }
 
 ofxTLNotes::~ofxTLNotes(){
+    ofRemoveListener(ofEvents().update, this, &ofxTLNotes::growNotes);
 }
 
 void ofxTLNotes::update(){
     
     long thisUpdateSample = timeline->getCurrentTimeMillis();
-    for (int i = 0; i < keyframes.size(); ++i) {
-        ofxTLNote* key = (ofxTLNote*)keyframes[i];
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+    std::unique_lock<std::mutex> lock(triggerLock);
+    for (int i = 0; i < keys.size(); ++i) {
+        ofxTLNote* key = (ofxTLNote*)keys[i];
+        ofxTLNoteTrigger& trigger = noteTriggers[key->undoId];
         
         // track trigger on/off
-        key->wasOn = key->isOn;
-        key->isOn = key->timeRange.contains(thisUpdateSample);
-        if(key->isOn && !key->wasOn){
-            key->triggeredOn = true;
+        trigger.wasOn = trigger.isOn;
+        trigger.isOn = key->timeRange.contains(thisUpdateSample);
+        if(trigger.isOn && !trigger.wasOn){
+            trigger.triggeredOn = true;
         }
-        else if (!key->isOn && key->wasOn){
-            key->triggeredOff = true;
+        else if (!trigger.isOn && trigger.wasOn){
+            trigger.triggeredOff = true;
         }
         
         // reset 'read' flag if we used it
-        if (key->triggerWasRead) {
-            key->triggeredOn = key->triggeredOff = false;
-            key->triggerWasRead = false;
+        if (trigger.triggerWasRead) {
+            trigger.triggeredOn = trigger.triggeredOff = false;
+            trigger.triggerWasRead = false;
         }
-        
-        // grow active notes
-        if(key->growing){
+    }
+    //forget the notes that were deleted
+    if(noteTriggers.size() > keys.size()){
+        std::map<unsigned int, ofxTLNoteTrigger> kept;
+        for (int i = 0; i < keys.size(); ++i) {
+            kept[keys[i]->undoId] = noteTriggers[keys[i]->undoId];
+        }
+        noteTriggers.swap(kept);
+    }
+    lock.unlock();
+    endPlaybackRead();
+}
+
+void ofxTLNotes::growNotes(ofEventArgs& args){
+    // grow active notes, this edits the live notes so playback sees it once it's published
+    bool looped = stopGrowing.exchange(false);
+    bool grew = false;
+    for (int i = 0; i < keyframes.size(); ++i) {
+        ofxTLNote* key = (ofxTLNote*)keyframes[i];
+        if(!key->growing){
+            continue;
+        }
+        if(looped){
+            key->growing = false;
+            key->endSelected = key->startSelected = false;
+            key->timeRange.max = getTimeline()->getOutTimeInMillis();
+        }
+        else{
             key->timeRange.max = currentTrackTime();
         }
-        
+        grew = true;
+    }
+    if(grew){
+        markChanged();
     }
 }
 
@@ -209,16 +243,17 @@ void ofxTLNotes::draw(){
 }
 
 bool ofxTLNotes::isOnAtMillis(long millis){
-    for(int i = 0; i < keyframes.size(); i++){
-        ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
-        if(switchKey->timeRange.min > millis){
-            break;
-        }
-        if(switchKey->timeRange.contains(millis)){
-            return true;
-        }
-    }
-    return false;
+    ofxTLKeyframeSnapshot* snapshot;
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead(snapshot);
+    bool on = switchIsOnAtMillis<ofxTLNote>(keys, snapshot, millis);
+    endPlaybackRead();
+    return on;
+}
+
+void ofxTLNotes::sampleOnAtMillis(const vector<unsigned long long>& millis, float* values){
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+    sampleSwitchesAtMillis<ofxTLNote>(keys, millis, values);
+    endPlaybackRead();
 }
 
 bool ofxTLNotes::isOn(){
@@ -226,16 +261,20 @@ bool ofxTLNotes::isOn(){
 }
 
 bool ofxTLNotes::pitchIsOnAtMillis(int pitch, long millis){
-    for(int i = 0; i < keyframes.size(); i++){
-        ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
+    bool on = false;
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+    for(int i = 0; i < keys.size(); i++){
+        ofxTLNote* switchKey = (ofxTLNote*)keys[i];
         if(switchKey->timeRange.min > millis){
             break;
         }
         if(switchKey->timeRange.contains(millis) && switchKey->pitch == pitch){
-            return true;
+            on = true;
+            break;
         }
     }
-    return false;
+    endPlaybackRead();
+    return on;
 }
 
 vector<float>* ofxTLNotes::getActiveNotes(){
@@ -395,18 +434,24 @@ void ofxTLNotes::mouseDragged(ofMouseEventArgs& args, long millis){
 		//look for any keys with just beginning and ends selected
 		//becaues of the logical in the mousePressed, there will never
 		//be a selected keyframe with an end selected
+		bool draggedEdge = false;
 		for(int i = 0; i < keyframes.size(); i++){
 			ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
 			if(switchKey->startSelected){
 				switchKey->timeRange.min = millis - switchKey->edgeDragOffset;
 				switchKey->time = switchKey->timeRange.min;
+				draggedEdge = true;
 			}
 			else if(switchKey->endSelected){
 				switchKey->timeRange.max = millis - switchKey->edgeDragOffset;
+				draggedEdge = true;
 			}
 		}
 		
 		updateTimeRanges();
+		if(draggedEdge){
+			markChanged();
+		}
 	}
 }
 
@@ -502,7 +547,35 @@ void ofxTLNotes::regionSelected(ofLongRange timeRange, ofRange valueRange){
     }
 }
 
-void ofxTLNotes::getSnappingPoints(std::set<unsigned long>& points){
+bool ofxTLNotes::updateSnapIndex(vector<unsigned long long>& index){
+	index.reserve(keyframes.size()*2);
+	for(int i = 0; i < keyframes.size(); i++){
+        ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
+		index.push_back(switchKey->timeRange.min);
+		index.push_back(switchKey->timeRange.max);
+	}
+	sort(index.begin(), index.end());
+	index.erase(unique(index.begin(), index.end()), index.end());
+	return true;
+}
+
+void ofxTLNotes::getSelectedSnappingPoints(vector<unsigned long long>& points){
+	for(int i = 0; i < selectedKeyframes.size(); i++){
+        ofxTLNote* switchKey = (ofxTLNote*)selectedKeyframes[i];
+		points.push_back(switchKey->timeRange.min);
+		points.push_back(switchKey->timeRange.max);
+	}
+	//dragging just one edge doesn't select the key
+	for(int i = 0; i < keyframes.size(); i++){
+        ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
+		if(switchKey->startSelected || switchKey->endSelected){
+			points.push_back(switchKey->timeRange.min);
+			points.push_back(switchKey->timeRange.max);
+		}
+	}
+}
+
+void ofxTLNotes::getSnappingPoints(std::set<unsigned long long>& points){
 	for(int i = 0; i < keyframes.size(); i++){
         ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
 		if (isKeyframeIsInBounds(switchKey) && !isKeyframeSelected(switchKey) &&
@@ -513,6 +586,19 @@ void ofxTLNotes::getSnappingPoints(std::set<unsigned long>& points){
 	}
 }
 
+//notes can overlap, only the ones still playing at millis are checked
+unsigned long long ofxTLNotes::getNextEventTime(unsigned long long millis){
+	ofxTLKeyframeSnapshot* snapshot;
+	vector<ofxTLKeyframe*>& keys = beginPlaybackRead(snapshot);
+	unsigned long long next = nextSwitchEdge<ofxTLNote>(keys, snapshot, millis);
+	endPlaybackRead();
+	return next;
+}
+
+void ofxTLNotes::indexPlaybackKeys(ofxTLKeyframeSnapshot* snapshot){
+	indexRangeEnds<ofxTLNote>(snapshot);
+}
+
 int ofxTLNotes::getSelectedItemCount(){
 	int numEdgesSelected = 0;
 	for(int i = 0; i < keyframes.size(); i++){
@@ -543,7 +629,14 @@ ofxTLKeyframe* ofxTLNotes::newKeyframe(){
     return switchKey;
 }
 
-void ofxTLNotes::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
+ofxTLKeyframe* ofxTLNotes::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLNote)){
+		return new ofxTLNote(*(ofxTLNote*)key);
+	}
+	return NULL;
+}
+
+void ofxTLNotes::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
     //pull the saved time into min, and our custom max value
     ofxTLNote* switchKey = (ofxTLNote*)key;
     // TODO: reset function for note?
@@ -555,7 +648,7 @@ void ofxTLNotes::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
     
     switchKey->timeRange.min = switchKey->time;
     //
-    string timecode = xmlStore.getValue("max", "00:00:00:000");
+    string timecode = keyTags.getValue("max", "00:00:00:000");
     if(timecode.find(":") == string::npos){
         switchKey->timeRange.max = ofToFloat(timecode) * timeline->getDurationInMilliseconds(); //Legacy max of 0-1
     }
@@ -566,15 +659,19 @@ void ofxTLNotes::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
     switchKey->startSelected = switchKey->endSelected = false;
     
     // restore pitch
-    int pitch = xmlStore.getValue("pitch", 0);
+    int pitch = keyTags.getValue("pitch", 0);
     switchKey->pitch = pitch;
     
-    float velocity = xmlStore.getValue("velocity", 0.0f);
+    float velocity = keyTags.getValue("velocity", 0.0f);
     switchKey->velocity = velocity;
 	
 	//a bit of a hack, but if
 	placingSwitch = NULL;
     trimToPitches();
+	//subclasses that read their own tags in restoreKeyframe still get them
+	if(typeid(*this) != typeid(ofxTLNotes)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
 }
 
 void ofxTLNotes::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
@@ -586,6 +683,52 @@ void ofxTLNotes::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
     xmlStore.addValue("velocity", switchKey->velocity);
 }
 
+bool ofxTLNotes::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	if(typeid(*key) != typeid(ofxTLNote)){
+		return false;
+	}
+    ofxTLNote* switchKey = (ofxTLNote* )key;
+    appendBinary(buffer, switchKey->timeRange.min);
+    appendBinary(buffer, switchKey->timeRange.max);
+    appendBinary(buffer, switchKey->pitch);
+    appendBinary(buffer, switchKey->velocity);
+	return true;
+}
+
+void ofxTLNotes::restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){
+    ofxTLNote* switchKey = (ofxTLNote*)key;
+    switchKey->wasOn = false;
+    switchKey->isOn = false;
+    switchKey->triggeredOn = false;
+    switchKey->triggeredOff = false;
+    switchKey->growing = false;
+    readBinary(buffer, switchKey->timeRange.min);
+    readBinary(buffer, switchKey->timeRange.max);
+    readBinary(buffer, switchKey->pitch);
+    readBinary(buffer, switchKey->velocity);
+    switchKey->time = switchKey->previousTime = switchKey->timeRange.min;
+    switchKey->startSelected = switchKey->endSelected = false;
+	placingSwitch = NULL;
+}
+
+void ofxTLNotes::restorePastedKeyframe(ofxTLKeyframe* key){
+    //notes have their own timeRange, so this can't go through the switches version
+    ofxTLNote* switchKey = (ofxTLNote*)key;
+    switchKey->growing = false;
+    switchKey->timeRange.min = switchKey->timeRange.max = switchKey->time;
+    switchKey->startSelected = switchKey->endSelected = false;
+    //the value picks the pitch the same way it's drawn
+    switchKey->pitch = ofClamp(roundf(ofMap(switchKey->value, 0, 1, valueRange.min, valueRange.max)), valueRange.min, valueRange.max);
+    switchKey->velocity = 1.0;
+	placingSwitch = NULL;
+}
+
+void ofxTLNotes::restoreUndoRecords(const string& removed, const string& written){
+    ofxTLSwitches::restoreUndoRecords(removed, written);
+    //once for all the keys rather than per key like restoreKeyframe
+    trimToPitches();
+}
+
 ofxTLKeyframe* ofxTLNotes::keyframeAtScreenpoint(ofVec2f p){
 	for(int i = 0; i < keyframes.size(); i++){
 		ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
@@ -646,15 +789,8 @@ void ofxTLNotes::playbackStarted(ofxTLPlaybackEventArgs &args){
 }
 
 void ofxTLNotes::playbackLooped(ofxTLPlaybackEventArgs &args){
-    for(int i = 0; i < keyframes.size(); i++){
-		ofxTLNote* switchKey = (ofxTLNote*)keyframes[i];
-    	if(switchKey->growing){
-            switchKey->growing = false;
-            switchKey->endSelected = switchKey->startSelected = false;
-            switchKey->timeRange.max = getTimeline()->getOutTimeInMillis();
-        }
-        
-    }
+    //this can come from the playback thread, growNotes() finishes the growing notes
+    stopGrowing = true;
 }
 
 void ofxTLNotes::trimToPitches(){
@@ -679,12 +815,23 @@ void ofxTLNotes::trimToPitches(){
 
 vector<ofxTLNote*> ofxTLNotes::getDirtyNotes(){
     vector<ofxTLNote*>notes;
+    std::unique_lock<std::mutex> lock(triggerLock);
     for (int i = 0; i < keyframes.size(); ++i) {
         ofxTLNote* sourceKey = (ofxTLNote*)keyframes[i];
-        if(sourceKey->triggeredOff || sourceKey->triggeredOn){
-            if(sourceKey->triggerWasRead == false){
-                notes.push_back(sourceKey);
+        std::map<unsigned int, ofxTLNoteTrigger>::iterator it = noteTriggers.find(sourceKey->undoId);
+        if(sourceKey->undoId == 0 || it == noteTriggers.end()){
+            continue;
+        }
+        ofxTLNoteTrigger& trigger = it->second;
+        if(trigger.triggeredOff || trigger.triggeredOn){
+            if(trigger.triggerWasRead == false){
+                sourceKey->isOn = trigger.isOn;
+                sourceKey->wasOn = trigger.wasOn;
+                sourceKey->triggeredOn = trigger.triggeredOn;
+                sourceKey->triggeredOff = trigger.triggeredOff;
                 sourceKey->triggerWasRead = true;
+                notes.push_back(sourceKey);
+                trigger.triggerWasRead = true;
             }
         }
     }
@@ -53,6 +53,19 @@ public:
     int pitch;
     float velocity;
 	bool growing;
+    //trigger state, only filled in on the notes getDirtyNotes returns
+    bool isOn;
+    bool wasOn;
+    bool triggeredOn;
+    bool triggeredOff;
+    bool triggerWasRead;
+};
+
+//what a note did on the last update. the track keeps these since
+//playback reads shared copies of the notes that can't be written to
+class ofxTLNoteTrigger {
+public:
+    ofxTLNoteTrigger() : isOn(false), wasOn(false), triggeredOn(false), triggeredOff(false), triggerWasRead(false) {};
     bool isOn;
     bool wasOn;
     bool triggeredOn;
@@ -68,12 +81,14 @@ public:
     // note-specific:
     int pitchForScreenY(int y);
     
+    //runs wherever the timeline updates, the thread or the worker pool, so it only reads the shared notes
     virtual void update();
     virtual void draw();
     
 	virtual bool isOn();
     virtual bool isOnAtMillis(long millis);
     virtual bool isOnAtPercent(float percent);
+    virtual void sampleOnAtMillis(const vector<unsigned long long>& millis, float* values);
 
     vector<float>* getActiveNotes();
     
@@ -82,7 +97,10 @@ public:
     virtual void mouseReleased(ofMouseEventArgs& args, long millis);
     virtual void mouseMoved(ofMouseEventArgs& args, long millis);
     
-    virtual void getSnappingPoints(std::set<unsigned long>& points);
+    virtual void getSnappingPoints(std::set<unsigned long long>& points);
+    virtual bool updateSnapIndex(vector<unsigned long long>& index);
+    virtual void getSelectedSnappingPoints(vector<unsigned long long>& points);
+    virtual unsigned long long getNextEventTime(unsigned long long millis);
     virtual void regionSelected(ofLongRange timeRange, ofRange valueRange);
     
     virtual void unselectAll();
@@ -99,8 +117,13 @@ public:
 	
 protected:
     virtual ofxTLKeyframe* newKeyframe();
-    virtual void restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+    virtual ofxTLKeyframe* copyKeyframe(ofxTLKeyframe* key);
+    virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
 	virtual void storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+	virtual bool storeKeyframeBinary(ofxTLKeyframe* key, string& buffer);
+	virtual void restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer);
+	virtual void restorePastedKeyframe(ofxTLKeyframe* key);
+    virtual void restoreUndoRecords(const string& removed, const string& written);
 	virtual ofxTLKeyframe* keyframeAtScreenpoint(ofVec2f p);
     virtual void updateEdgeDragOffsets(long clickMillis);
 	virtual int getSelectedItemCount();
@@ -108,6 +131,7 @@ protected:
     
 	//pushes any edits from keyframes superclass into the switches system
 	virtual void updateTimeRanges();
+	virtual void indexPlaybackKeys(ofxTLKeyframeSnapshot* snapshot);
 	
     bool startHover;
     bool endHover;
@@ -116,6 +140,14 @@ protected:
     bool pitchIsOnAtMillis(int pitch, long millis);
     long lastUpdateSample;
     vector<float> *_activeNotes;
+    //by undoId, which the shared notes keep from the live ones.
+    //update() writes them and getDirtyNotes() reads them on the main thread, both under triggerLock
+    std::map<unsigned int, ofxTLNoteTrigger> noteTriggers;
+    std::mutex triggerLock;
+    //growing notes edit the live notes, so they're grown on the main thread's update event
+    void growNotes(ofEventArgs& args);
+    //set by a loop, the next growNotes() stops the growing notes
+    std::atomic<bool> stopGrowing;
     
     void playbackLooped(ofxTLPlaybackEventArgs &args);
     void playbackStarted(ofxTLPlaybackEventArgs &args);
@@ -0,0 +1,200 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLOfflineRenderer.h"
+#include "ofxTimeline.h"
+
+ofxTLOfflineRenderer::ofxTLOfflineRenderer()
+:	timeline(NULL),
+	useOwnFrameRate(false),
+	parallel(false),
+	cancelled(false)
+{
+	//
+}
+
+ofxTLOfflineRenderer::~ofxTLOfflineRenderer(){
+
+}
+
+void ofxTLOfflineRenderer::setup(ofxTimeline* newTimeline){
+	timeline = newTimeline;
+}
+
+void ofxTLOfflineRenderer::setFrameRate(int fpsNumerator, int fpsDenominator){
+	timecode.setFPS(fpsNumerator, fpsDenominator);
+	useOwnFrameRate = true;
+}
+
+void ofxTLOfflineRenderer::useTimelineFrameRate(){
+	useOwnFrameRate = false;
+}
+
+void ofxTLOfflineRenderer::setParallel(bool shouldRenderInParallel, int numThreads){
+	parallel = shouldRenderInParallel;
+	if(parallel){
+		workerPool.setup(numThreads);
+	}
+	else{
+		workerPool.shutdown();
+	}
+}
+
+bool ofxTLOfflineRenderer::getParallel(){
+	return parallel;
+}
+
+bool ofxTLOfflineRenderer::canRenderInParallel(){
+	if(timeline == NULL){
+		return false;
+	}
+	vector<ofxTLPage*>& pages = timeline->getPages();
+	for(int i = 0; i < pages.size(); i++){
+		vector<ofxTLTrack*>& tracks = pages[i]->getTracks();
+		for(int t = 0; t < tracks.size(); t++){
+			if(!tracks[t]->canRenderInParallel()){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int ofxTLOfflineRenderer::getNumFrames(){
+	if(timeline == NULL){
+		return 0;
+	}
+	ofxTimecode& rate = useOwnFrameRate ? timecode : timeline->getTimecode();
+	return MAX(rate.frameForMillis(timeline->getOutTimeInMillis() - timeline->getInTimeInMillis()), 1);
+}
+
+void ofxTLOfflineRenderer::cancel(){
+	cancelled = true;
+}
+
+int ofxTLOfflineRenderer::render(std::function<void(const ofxTLRenderFrame&)> onFrame){
+	if(timeline == NULL){
+		ofLogError("ofxTLOfflineRenderer::render") << "Call setup() with a timeline first";
+		return 0;
+	}
+	if(timeline->isOnThread){
+		ofLogError("ofxTLOfflineRenderer::render") << "Take the timeline off its thread or scheduler before rendering";
+		return 0;
+	}
+
+	timeline->stop();
+	if(timeline->getIsPlaying()){
+		ofLogError("ofxTLOfflineRenderer::render") << "The timeline is still playing, stop its time control track first";
+		return 0;
+	}
+
+	if(!useOwnFrameRate){
+		timecode = timeline->getTimecode();
+	}
+	cancelled = false;
+
+	if(parallel){
+		if(canRenderInParallel()){
+			return renderParallel(onFrame);
+		}
+		ofLogWarning("ofxTLOfflineRenderer::render") << "Some tracks keep state between frames, rendering serially";
+	}
+	return renderSerial(onFrame);
+}
+
+int ofxTLOfflineRenderer::renderSerial(std::function<void(const ofxTLRenderFrame&)>& onFrame){
+	unsigned long long inMillis = timeline->getInTimeInMillis();
+	int numFrames = getNumFrames();
+
+	//tracks forget what they've fired the same way they do when playback starts
+	timeline->setCurrentTimeMillis(inMillis);
+	ofxTLPlaybackEventArgs args = timeline->createPlaybackEvent();
+	ofNotifyEvent(timeline->events().playbackStarted, args);
+
+	int frame = 0;
+	for(; frame < numFrames && !cancelled; frame++){
+		ofxTLRenderFrame renderFrame;
+		renderFrame.frame = frame;
+		renderFrame.millis = inMillis + timecode.millisForFrame(frame);
+
+		//stop at every event on the way, so events on different tracks fire in time order
+		//and nothing shorter than a frame is skipped
+		unsigned long long next = getNextEventTime(timeline->getCurrentTimeMillis());
+		while(next <= renderFrame.millis){
+			stepTo(next);
+			next = getNextEventTime(next);
+		}
+		stepTo(renderFrame.millis);
+
+		onFrame(renderFrame);
+	}
+
+	args = timeline->createPlaybackEvent();
+	ofNotifyEvent(timeline->events().playbackEnded, args);
+	return frame;
+}
+
+int ofxTLOfflineRenderer::renderParallel(std::function<void(const ofxTLRenderFrame&)>& onFrame){
+	unsigned long long inMillis = timeline->getInTimeInMillis();
+	int numFrames = getNumFrames();
+
+	//a few chunks per thread so slow stretches of the show even out
+	int numChunks = MIN(numFrames, (workerPool.getNumWorkers()+1) * 4);
+	std::atomic<int> framesRendered(0);
+	workerPool.parallelFor(numChunks, [&](int chunk){
+		int begin = (long long)numFrames * chunk / numChunks;
+		int end = (long long)numFrames * (chunk+1) / numChunks;
+		ofxTLRenderFrame renderFrame;
+		for(int frame = begin; frame < end && !cancelled; frame++){
+			renderFrame.frame = frame;
+			renderFrame.millis = inMillis + timecode.millisForFrame(frame);
+			onFrame(renderFrame);
+			framesRendered++;
+		}
+	});
+	return framesRendered;
+}
+
+unsigned long long ofxTLOfflineRenderer::getNextEventTime(unsigned long long millis){
+	unsigned long long next = ULLONG_MAX;
+	vector<ofxTLPage*>& pages = timeline->getPages();
+	for(int i = 0; i < pages.size(); i++){
+		next = MIN(next, pages[i]->getNextEventTime(millis));
+	}
+	return next;
+}
+
+void ofxTLOfflineRenderer::stepTo(unsigned long long millis){
+	//the timeline is stopped and off its thread, so there's nothing to sync or wake
+	timeline->currentTimeMicros = millis*1000;
+	timeline->checkEvents();
+}
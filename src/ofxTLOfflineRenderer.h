@@ -0,0 +1,100 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxTimecode.h"
+#include "ofxTLWorkerPool.h"
+#include <atomic>
+#include <functional>
+
+class ofxTLRenderFrame {
+  public:
+	int frame; //counted from the in point
+	unsigned long long millis;
+};
+
+//steps a timeline from its in point to its out point at a fixed frame rate,
+//as fast as the cpu allows and without looking at the clock. bangs, switches and
+//notes fire in time order as the playhead reaches them, then onFrame is called
+//so you can take a snapshot of the tracks.
+//
+//  ofxTLOfflineRenderer renderer;
+//  renderer.setup(&timeline);
+//  renderer.render([&](const ofxTLRenderFrame& frame){
+//      cues.push_back(timeline.getValue("Dimmer", (float)frame.millis/1000.));
+//  });
+//
+//the timeline has to be stopped and not on a thread or scheduler while rendering
+class ofxTimeline;
+class ofxTLOfflineRenderer {
+  public:
+	ofxTLOfflineRenderer();
+	virtual ~ofxTLOfflineRenderer();
+
+	void setup(ofxTimeline* timeline);
+
+	//renders at the timeline's own frame rate unless one is set here
+	void setFrameRate(int fpsNumerator, int fpsDenominator = 1);
+	void useTimelineFrameRate();
+
+	//splits the frames into chunks rendered on a pool of threads. only used when
+	//canRenderInParallel(), otherwise render() steps through serially as usual.
+	//in parallel onFrame is called from several threads in no particular order,
+	//no events fire and tracks must be sampled at frame.millis, not the playhead
+	void setParallel(bool parallel, int numThreads = 0);
+	bool getParallel();
+	//false if any track keeps state between frames, like bangs, switches, notes or your own tracks
+	bool canRenderInParallel();
+
+	//returns the number of frames rendered
+	int render(std::function<void(const ofxTLRenderFrame&)> onFrame);
+	//stops the render after the current frame, safe to call from onFrame or an event listener
+	void cancel();
+
+	int getNumFrames();
+
+  protected:
+	ofxTimeline* timeline;
+	ofxTimecode timecode;
+	bool useOwnFrameRate;
+	bool parallel;
+	ofxTLWorkerPool workerPool;
+	std::atomic<bool> cancelled;
+
+	int renderSerial(std::function<void(const ofxTLRenderFrame&)>& onFrame);
+	int renderParallel(std::function<void(const ofxTLRenderFrame&)>& onFrame);
+	unsigned long long getNextEventTime(unsigned long long millis);
+	//moves the playhead and updates every track so events due by then fire
+	void stepTo(unsigned long long millis);
+};
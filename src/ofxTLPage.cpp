@@ -58,8 +58,8 @@ ofxTLPage::~ofxTLPage(){
 		ofRemoveListener(timeline->events().zoomEnded, this, &ofxTLPage::zoomEnded);
         isSetup = false;
 		for(int i = 0; i < headers.size(); i++){
-			if(tracks[headers[i]->name]->getCreatedByTimeline()){
-				delete tracks[headers[i]->name];
+			if(headers[i]->getTrack()->getCreatedByTimeline()){
+				delete headers[i]->getTrack();
 			}
 			delete headers[i];
 		}
@@ -75,7 +75,7 @@ void ofxTLPage::setup(){
         isSetup = true;
         headerHeight = 18;
         defaultTrackHeight = 40;
-        if(ofGetScreenWidth() >= 2560 && ofGetScreenHeight() >= 1600){
+        if(!timeline->getIsHeadless() && ofGetScreenWidth() >= 2560 && ofGetScreenHeight() >= 1600){
             headerHeight *= 2;
             defaultTrackHeight *= 2;
         }
@@ -87,26 +87,49 @@ void ofxTLPage::setup(){
 //given a folder the page will look for xml files to load within that
 void ofxTLPage::loadTracksFromFolder(string folderPath){
     for(int i = 0; i < headers.size(); i++){
-		string filename = folderPath + tracks[headers[i]->name]->getXMLFileName();
-        tracks[headers[i]->name]->setXMLFileName(filename);
-        tracks[headers[i]->name]->load();
+		string filename = folderPath + headers[i]->getTrack()->getXMLFileName();
+        headers[i]->getTrack()->setXMLFileName(filename);
+        OFXTL_PROFILE_SCOPE(headers[i]->getTrack(), OFXTL_PROFILE_LOAD);
+        headers[i]->getTrack()->load();
+    }
+}
+
+void ofxTLPage::beginLoadingTracksFromFolder(string folderPath, vector<ofxTLLoadJob*>& jobs){
+    for(int i = 0; i < headers.size(); i++){
+		ofxTLTrack* track = headers[i]->getTrack();
+		track->setXMLFileName(folderPath + track->getXMLFileName());
+		ofxTLLoadJob* job = track->beginBackgroundLoad();
+		if(job != NULL){
+			jobs.push_back(job);
+		}
+		else{
+			OFXTL_PROFILE_SCOPE(track, OFXTL_PROFILE_LOAD);
+			track->load();
+		}
+    }
+}
+
+void ofxTLPage::loadEditorData(){
+    for(int i = 0; i < headers.size(); i++){
+		headers[i]->getTrack()->loadEditorData();
     }
 }
 
 //given a folder the page will look for xml files to load within that
 void ofxTLPage::saveTracksToFolder(string folderPath){
     for(int i = 0; i < headers.size(); i++){
-		string filename = folderPath + tracks[headers[i]->name]->getXMLFileName();
-        tracks[headers[i]->name]->setXMLFileName(filename);
-		tracks[headers[i]->name]->save();
+		string filename = folderPath + headers[i]->getTrack()->getXMLFileName();
+        headers[i]->getTrack()->setXMLFileName(filename);
+		OFXTL_PROFILE_SCOPE(headers[i]->getTrack(), OFXTL_PROFILE_SAVE);
+		headers[i]->getTrack()->save();
     }
 }
 
 void ofxTLPage::timelineChangedName(string newName, string oldName){
     for(int i = 0; i < headers.size(); i++){
-		string filename = tracks[headers[i]->name]->getXMLFileName();
+		string filename = headers[i]->getTrack()->getXMLFileName();
 		ofStringReplace(filename, oldName+"_", newName+"_");
-        tracks[headers[i]->name]->setXMLFileName(filename);
+        headers[i]->getTrack()->setXMLFileName(filename);
     }
 }
 
@@ -116,30 +139,47 @@ void ofxTLPage::setTicker(ofxTLTicker* t){
 
 //used to poll events off the update cycle
 void ofxTLPage::update(){
+	if(!timeline->getParallelUpdate() || headers.size() < 2){
+		for(int i = 0; i < headers.size(); i++){
+			OFXTL_PROFILE_SCOPE(headers[i]->getTrack(), OFXTL_PROFILE_UPDATE);
+			headers[i]->getTrack()->update();
+		}
+		return;
+	}
+
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->update();
+		headers[i]->getTrack()->setDeferNotifications(true);
+	}
+
+	timeline->getWorkerPool().parallelFor(headers.size(), [this](int i){
+		OFXTL_PROFILE_SCOPE(headers[i]->getTrack(), OFXTL_PROFILE_UPDATE);
+		headers[i]->getTrack()->update();
+	});
+
+	//send out whatever fired in track order, from this thread
+	for(int i = 0; i < headers.size(); i++){
+		headers[i]->getTrack()->setDeferNotifications(false);
+		headers[i]->getTrack()->flushNotifications();
 	}
 }
 
 void ofxTLPage::draw(){	
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->_draw();
+		headers[i]->getTrack()->_draw();
 		headers[i]->draw();
 	}
 	
 	if(!headerHasFocus && !footerIsDragging && draggingInside && snapPoints.size() > 0){
 		ofPushStyle();
 		ofSetColor(255,255,255,100);
-		std::set<unsigned long long>::iterator it;
-//		for(int i = 0; i < snapPoints.size(); i++){
-		for(it = snapPoints.begin(); it != snapPoints.end(); it++){
-            ofDrawLine(timeline->millisToScreenX(*it), trackContainerRect.y,timeline->millisToScreenX(*it), trackContainerRect.y+trackContainerRect.height);
+		for(int i = 0; i < snapPoints.size(); i++){
+            ofDrawLine(timeline->millisToScreenX(snapPoints[i]), trackContainerRect.y,timeline->millisToScreenX(snapPoints[i]), trackContainerRect.y+trackContainerRect.height);
 		}
 		ofPopStyle();
 	}
 	
 //	for(int i = 0; i < headers.size(); i++){
-//		tracks[headers[i]->name]->drawModalContent();
+//		headers[i]->getTrack()->drawModalContent();
 //	}
     
     if(draggingSelectionRectangle){
@@ -176,16 +216,16 @@ void ofxTLPage::mousePressed(ofMouseEventArgs& args, long millis){
 		
 		for(int i = 0; i < headers.size(); i++){
             bool clickIsInHeader = headers[i]->getDrawRect().inside(args.x,args.y);
-            bool clickIsInTrack = tracks[headers[i]->name]->getDrawRect().inside(args.x,args.y);
+            bool clickIsInTrack = headers[i]->getTrack()->getDrawRect().inside(args.x,args.y);
             bool clickIsInFooter = headers[i]->getFooterRect().inside(args.x,args.y);
-            bool justMadeSelection = tracks[headers[i]->name]->_mousePressed(args, millis);
+            bool justMadeSelection = headers[i]->getTrack()->_mousePressed(args, millis);
             headerHasFocus |= (clickIsInFooter || clickIsInHeader) && !justMadeSelection;
 			footerIsDragging |= clickIsInFooter;
 			if(headerHasFocus){
 				headers[i]->mousePressed(args);
 			}
             if(clickIsInTrack || clickIsInHeader || justMadeSelection){
-                newFocus = tracks[ headers[i]->name ];
+                newFocus = headers[i]->getTrack();
             }
 		}
 		
@@ -221,7 +261,7 @@ ofxTLTrack* ofxTLPage::getFocusedTrack(){
 void ofxTLPage::mouseMoved(ofMouseEventArgs& args, long millis){
 	for(int i = 0; i < headers.size(); i++){
 		headers[i]->mouseMoved(args);
-        tracks[headers[i]->name]->_mouseMoved(args, millis);
+        headers[i]->getTrack()->_mouseMoved(args, millis);
 	}
     
     if(!draggingInside){
@@ -271,25 +311,23 @@ void ofxTLPage::mouseDragged(ofMouseEventArgs& args, long millis){
 
 		if(snappingEnabled && snapPoints.size() > 0){
 			//hack to find snap distance in millseconds
-			std::set<unsigned long long>::iterator it;
 			long snappingToleranceMillis = timeline->screenXToMillis(snappingTolerance) - timeline->screenXToMillis(0);
 			long closestSnapDistance = snappingToleranceMillis;
 			long closestSnapPoint;
-			//int closestSnapPoint;
-	//            for(int i = 0; i < snapPoints.size(); i++){
-			for(it = snapPoints.begin(); it != snapPoints.end(); it++){
-                long pointDifference = millis - millisecondDragOffset - *it;
-				long distanceToPoint = abs(pointDifference);
-				if(distanceToPoint < closestSnapDistance){
-	//                    closestSnapPoint = i;
-					closestSnapPoint = *it;
-					closestSnapDistance = distanceToPoint;
-				}
+			//only the points either side of the drag can be the closest
+			long dragMillis = millis - millisecondDragOffset;
+			vector<unsigned long long>::iterator next = lower_bound(snapPoints.begin(), snapPoints.end(), (unsigned long long)MAX(dragMillis, 0L));
+			if(next != snapPoints.end() && long(*next - dragMillis) < closestSnapDistance){
+				closestSnapPoint = *next;
+				closestSnapDistance = *next - dragMillis;
+			}
+			if(next != snapPoints.begin() && long(dragMillis - *(next-1)) < closestSnapDistance){
+				closestSnapPoint = *(next-1);
+				closestSnapDistance = dragMillis - *(next-1);
 			}
 			
 			if(abs(closestSnapDistance) < snappingToleranceMillis){
 				//if we snapped, add the global drag offset to compensate for it being subtracted inside of the track
-				//millis = snapPoints[closestSnapPoint] + millisecondDragOffset;
 				millis = closestSnapPoint + millisecondDragOffset;
 			}
 		}
@@ -299,7 +337,7 @@ void ofxTLPage::mouseDragged(ofMouseEventArgs& args, long millis){
 	for(int i = 0; i < headers.size(); i++){
 		headers[i]->mouseDragged(args);
 		if(!headerHasFocus){
-			tracks[headers[i]->name]->_mouseDragged(args, millis);
+			headers[i]->getTrack()->_mouseDragged(args, millis);
 		}
 	}
 }
@@ -308,7 +346,7 @@ void ofxTLPage::mouseReleased(ofMouseEventArgs& args, long millis){
 	if(draggingInside){
 		for(int i = 0; i < headers.size(); i++){
 			headers[i]->mouseReleased(args);
-			tracks[headers[i]->name]->_mouseReleased(args, millis);
+			headers[i]->getTrack()->_mouseReleased(args, millis);
 		}		
 		draggingInside = false;
         timeline->setHoverTime(millis);
@@ -322,7 +360,7 @@ void ofxTLPage::mouseReleased(ofMouseEventArgs& args, long millis){
         ofLongRange timeRange = ofLongRange(timeline->screenXToMillis(selectionRectangle.x),
                                             timeline->screenXToMillis(selectionRectangle.x+selectionRectangle.width));
 		for(int i = 0; i < headers.size(); i++){
-            ofRectangle trackBounds = tracks[headers[i]->name]->getDrawRect();
+            ofRectangle trackBounds = headers[i]->getTrack()->getDrawRect();
 			ofRange valueRange;
 			//if we have a collapsed track
 			if(trackBounds.height == 0){
@@ -340,7 +378,7 @@ void ofxTLPage::mouseReleased(ofMouseEventArgs& args, long millis){
 			}
 			
             if(valueRange.min != valueRange.max){
-				tracks[headers[i]->name]->regionSelected(timeRange, valueRange);
+				headers[i]->getTrack()->regionSelected(timeRange, valueRange);
 			}
 		}		        
     }
@@ -356,45 +394,54 @@ void ofxTLPage::setSnappingEnabled(bool enabled){
 }
 
 void ofxTLPage::refreshSnapPoints(){
-	//get the snapping points
+	//get the snapping points. each track keeps a sorted index that only
+	//changes with the track, the visible part of each is merged in here
 	snapPoints.clear();
+	unsigned long long visibleMin = currentZoomBounds.min * timeline->getDurationInMilliseconds();
+	unsigned long long visibleMax = currentZoomBounds.max * timeline->getDurationInMilliseconds();
 	if(timeline->getSnapToOtherElements()){
 		for(int i = 0; i < headers.size(); i++){
-			tracks[headers[i]->name]->getSnappingPoints(snapPoints);	
+			mergeSnapPoints(headers[i]->getTrack(), visibleMin, visibleMax);
 		}
 	}
     
     if(ticker != nullptr && timeline->getSnapToBPM()){
-		ticker->getSnappingPoints(snapPoints);
+		mergeSnapPoints(ticker, visibleMin, visibleMax);
 	}
 	
 	if(snapPoints.size() > 2){
+		//drop points closer than the tolerance to the next one
 		long snappingToleranceMillis = timeline->screenXToMillis(snappingTolerance) - timeline->screenXToMillis(0);
-		std::set<unsigned long long>::iterator it = snapPoints.begin();
-		vector<unsigned long long> toRemove;
-		while(true){
-			unsigned long long a = *it++;
-			if(it == snapPoints.end()){
-				break;
-			}
-
-			unsigned long long b = *it;
-			if(b - a < snappingToleranceMillis){
-				toRemove.push_back(a);
+		int kept = 0;
+		for(int i = 0; i < snapPoints.size(); i++){
+			if(i+1 < snapPoints.size() && snapPoints[i+1] - snapPoints[i] < snappingToleranceMillis){
+				continue;
 			}
+			snapPoints[kept++] = snapPoints[i];
 		}
-
-		for(int i = 0; i < toRemove.size(); i++){
-			snapPoints.erase( toRemove[i] );
-		}
+		snapPoints.resize(kept);
 	}
 }
 
+void ofxTLPage::mergeSnapPoints(ofxTLTrack* track, unsigned long long visibleMin, unsigned long long visibleMax){
+	const vector<unsigned long long>& index = track->getSnapIndex();
+	selectedSnapPoints.clear();
+	track->getSelectedSnappingPoints(selectedSnapPoints);
+	sort(selectedSnapPoints.begin(), selectedSnapPoints.end());
+
+	size_t merged = snapPoints.size();
+	set_difference(lower_bound(index.begin(), index.end(), visibleMin),
+				   upper_bound(index.begin(), index.end(), visibleMax),
+				   selectedSnapPoints.begin(), selectedSnapPoints.end(),
+				   back_inserter(snapPoints));
+	inplace_merge(snapPoints.begin(), snapPoints.begin() + merged, snapPoints.end());
+}
+
 //copy paste
 void ofxTLPage::copyRequest(vector<string>& bufs){
 
 	for(int i = 0; i < headers.size(); i++){
-		string buf = tracks[headers[i]->name]->copyRequest();
+		string buf = headers[i]->getTrack()->copyRequest();
 		if(buf != ""){
 //			cout << "copy for " << i << " returned " << buf << endl;
 			bufs.push_back(buf);
@@ -404,7 +451,9 @@ void ofxTLPage::copyRequest(vector<string>& bufs){
 
 void ofxTLPage::cutRequest(vector<string>& bufs){
 	for(int i = 0; i < headers.size(); i++){
-		string buf = tracks[headers[i]->name]->cutRequest();
+		headers[i]->getTrack()->beginEdit();
+		string buf = headers[i]->getTrack()->cutRequest();
+		headers[i]->getTrack()->endEdit();
 		if(buf != ""){
 			bufs.push_back(buf);
 		}
@@ -434,7 +483,10 @@ void ofxTLPage::pasteSent(const vector<string>& pasteboard){
 				}
 //				cout << "pasting buffer " << bufferIndex << " into " << pasteTrackIndex << endl;
 				//paste the next bufer into the next track
-				headers[pasteTrackIndex++]->getTrack()->pasteSent(pasteboard[bufferIndex++]);
+				ofxTLTrack* pasteTrack = headers[pasteTrackIndex++]->getTrack();
+				pasteTrack->beginEdit();
+				pasteTrack->pasteSent(pasteboard[bufferIndex++]);
+				pasteTrack->endEdit();
 			}
 		}
     }
@@ -448,13 +500,17 @@ void ofxTLPage::selectAll(){
 
 void ofxTLPage::keyPressed(ofKeyEventArgs& args){
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->keyPressed(args);
+		headers[i]->getTrack()->beginEdit();
+		headers[i]->getTrack()->keyPressed(args);
+		headers[i]->getTrack()->endEdit();
 	}
 }
 
 void ofxTLPage::nudgeBy(ofVec2f nudgePercent){
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->nudgeBy(nudgePercent);
+		headers[i]->getTrack()->beginEdit();
+		headers[i]->getTrack()->nudgeBy(nudgePercent);
+		headers[i]->getTrack()->endEdit();
 	}
 }
 
@@ -507,6 +563,14 @@ vector<ofxTLTrack*>& ofxTLPage::getTracks(){
 	return trackList;
 }
 
+unsigned long long ofxTLPage::getNextEventTime(unsigned long long millis){
+	unsigned long long next = ULLONG_MAX;
+	for(int i = 0; i < headers.size(); i++){
+		next = MIN(next, headers[i]->getTrack()->getNextEventTime(millis));
+	}
+	return next;
+}
+
 ofxTLTrack* ofxTLPage::getTrack(string trackName){
 	if(tracks.find(trackName) == tracks.end()){
 		ofLogError("ofxTLPage -- Couldn't find element named " + trackName + " on page " + name);
@@ -676,7 +740,7 @@ void ofxTLPage::recalculateHeight(){
 
 	for(int i = 0; i < headers.size(); i++){
 		ofRectangle thisHeader = headers[i]->getDrawRect();
-		ofRectangle trackRectangle = tracks[ headers[i]->name ]->getDrawRect();
+		ofRectangle trackRectangle = headers[i]->getTrack()->getDrawRect();
 		
 		//float startY = thisHeader.y+thisHeader.height;
         float startY = currentY+thisHeader.height;
@@ -716,9 +780,9 @@ void ofxTLPage::recalculateHeight(){
 		}
 
 		headers[i]->setDrawRect(thisHeader);
-		tracks[ headers[i]->name ]->setDrawRect( trackRectangle );
+		headers[i]->getTrack()->setDrawRect( trackRectangle );
         
-//        cout << "	setting track " << tracks[ headers[i]->name ]->getName() << " to " << trackRectangle.y << endl;
+//        cout << "	setting track " << headers[i]->getTrack()->getName() << " to " << trackRectangle.y << endl;
         
 		
 		savedTrackPositions[headers[i]->name] = trackRectangle;
@@ -822,19 +886,20 @@ void ofxTLPage::setName(string newName){
 
 void ofxTLPage::unselectAll(){
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->unselectAll();
+		headers[i]->getTrack()->unselectAll();
 	}	
 }
 
 void ofxTLPage::clear(){
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->clear();
+		headers[i]->getTrack()->clear();
     }
 }
 
 void ofxTLPage::save(){
 	for(int i = 0; i < headers.size(); i++){
-		tracks[headers[i]->name]->save();
+		OFXTL_PROFILE_SCOPE(headers[i]->getTrack(), OFXTL_PROFILE_SAVE);
+		headers[i]->getTrack()->save();
     }
 }
 
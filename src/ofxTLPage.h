@@ -94,9 +94,17 @@ class ofxTLPage {
     //computed on the fly so please use sparingly if you have to call it a lot
     vector<ofxTLTrack*>& getTracks();
 
+	//earliest upcoming event time across all tracks, ULLONG_MAX if there is none
+	unsigned long long getNextEventTime(unsigned long long millis);
+
     //given a folder the page will look for xml files to load within that
 	void loadTracksFromFolder(string folderPath);
+	//points the tracks at the folder, loads the ones that can't load in the background
+	//and adds jobs for the rest
+	void beginLoadingTracksFromFolder(string folderPath, vector<ofxTLLoadJob*>& jobs);
     void saveTracksToFolder(string folderPath);
+	//see ofxTimeline::setLazyPageLoading
+	void loadEditorData();
 	
 	//this will swap out the xml file names that have been set to default based on the timeline name
 	void timelineChangedName(string newName, string oldName);
@@ -152,11 +160,13 @@ class ofxTLPage {
 	bool footerIsDragging;
 	bool snappingEnabled;
 	
-	std::set<unsigned long long> snapPoints; //in millis
+	vector<unsigned long long> snapPoints; //in millis, sorted
+	vector<unsigned long long> selectedSnapPoints;
 	float snappingTolerance; //in pixels
 	virtual void zoomEnded(ofxTLZoomEventArgs& args);
 	
 	void refreshSnapPoints();
+	void mergeSnapPoints(ofxTLTrack* track, unsigned long long visibleMin, unsigned long long visibleMax);
 	
 	long millisecondDragOffset;
 	
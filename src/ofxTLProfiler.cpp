@@ -0,0 +1,225 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLProfiler.h"
+#include "ofxTLTrack.h"
+#include "ofxTLSerialization.h"
+
+#ifdef OFXTL_PROFILE_ALLOCATIONS
+static thread_local unsigned long long allocationCount = 0;
+
+void* operator new(size_t size){
+	allocationCount++;
+	void* memory = malloc(size == 0 ? 1 : size);
+	if(memory == NULL){
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](size_t size){
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	free(memory);
+}
+#endif
+
+ofxTLProfileSection::ofxTLProfileSection()
+:	calls(0),
+	totalMicros(0),
+	maxMicros(0),
+	allocations(0)
+{
+	memset(histogram, 0, sizeof(histogram));
+}
+
+void ofxTLProfileSection::add(unsigned long long micros, unsigned long long newAllocations){
+	calls++;
+	totalMicros += micros;
+	maxMicros = MAX(maxMicros, micros);
+	allocations += newAllocations;
+	int bucket = 0;
+	while(micros > 0 && bucket < OFXTL_PROFILE_BUCKETS-1){
+		micros >>= 1;
+		bucket++;
+	}
+	histogram[bucket]++;
+}
+
+void ofxTLTrackProfile::add(int section, unsigned long long micros, unsigned long long allocations){
+	std::unique_lock<std::mutex> guard(lock);
+	sections[section].add(micros, allocations);
+}
+
+void ofxTLTrackProfile::get(ofxTLProfileSection* copy){
+	std::unique_lock<std::mutex> guard(lock);
+	for(int i = 0; i < OFXTL_PROFILE_NUM_SECTIONS; i++){
+		copy[i] = sections[i];
+	}
+}
+
+void ofxTLTrackProfile::reset(){
+	std::unique_lock<std::mutex> guard(lock);
+	for(int i = 0; i < OFXTL_PROFILE_NUM_SECTIONS; i++){
+		sections[i] = ofxTLProfileSection();
+	}
+}
+
+bool ofxTLProfiler::isEnabled(){
+#ifdef OFXTL_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+string ofxTLProfiler::getSectionName(int section){
+	switch(section){
+		case OFXTL_PROFILE_UPDATE: return "update";
+		case OFXTL_PROFILE_DRAW: return "draw";
+		case OFXTL_PROFILE_PREVIEWS: return "previews";
+		case OFXTL_PROFILE_SAMPLE: return "sample";
+		case OFXTL_PROFILE_SAVE: return "save";
+		case OFXTL_PROFILE_LOAD: return "load";
+		case OFXTL_PROFILE_UNDO: return "undo";
+	}
+	return "unknown";
+}
+
+unsigned long long ofxTLProfiler::getAllocationCount(){
+#ifdef OFXTL_PROFILE_ALLOCATIONS
+	return allocationCount;
+#else
+	return 0;
+#endif
+}
+
+static string jsonString(const string& text){
+	string escaped = "\"";
+	for(int i = 0; i < text.size(); i++){
+		unsigned char c = text[i];
+		if(c == '"' || c == '\\'){
+			escaped += '\\';
+			escaped += c;
+		}
+		else if(c < 0x20){
+			char code[8];
+			sprintf(code, "\\u%04x", c);
+			escaped += code;
+		}
+		else{
+			escaped += c;
+		}
+	}
+	return escaped + "\"";
+}
+
+string ofxTLProfiler::getStatsCSV(const vector<ofxTLTrackStats>& stats){
+	stringstream csv;
+	csv << "track,type,section,calls,total_micros,max_micros,mean_micros,allocations" << endl;
+	for(int i = 0; i < stats.size(); i++){
+		for(int s = 0; s < OFXTL_PROFILE_NUM_SECTIONS; s++){
+			const ofxTLProfileSection& section = stats[i].sections[s];
+			if(section.calls == 0){
+				continue;
+			}
+			csv << ofxTLSerialization::csvField(stats[i].name) << ","
+				<< ofxTLSerialization::csvField(stats[i].type) << ","
+				<< getSectionName(s) << ","
+				<< section.calls << ","
+				<< section.totalMicros << ","
+				<< section.maxMicros << ","
+				<< section.totalMicros / section.calls << ","
+				<< section.allocations << endl;
+		}
+	}
+	return csv.str();
+}
+
+string ofxTLProfiler::getStatsJSON(const vector<ofxTLTrackStats>& stats){
+	stringstream json;
+	json << "{\"tracks\":[";
+	for(int i = 0; i < stats.size(); i++){
+		json << (i > 0 ? "," : "") << "{\"name\":" << jsonString(stats[i].name)
+			 << ",\"type\":" << jsonString(stats[i].type) << ",\"sections\":{";
+		bool first = true;
+		for(int s = 0; s < OFXTL_PROFILE_NUM_SECTIONS; s++){
+			const ofxTLProfileSection& section = stats[i].sections[s];
+			if(section.calls == 0){
+				continue;
+			}
+			json << (first ? "" : ",") << "\"" << getSectionName(s) << "\":{"
+				 << "\"calls\":" << section.calls
+				 << ",\"totalMicros\":" << section.totalMicros
+				 << ",\"maxMicros\":" << section.maxMicros
+				 << ",\"allocations\":" << section.allocations
+				 << ",\"histogram\":[";
+			//trailing empty buckets are left off
+			int numBuckets = OFXTL_PROFILE_BUCKETS;
+			while(numBuckets > 1 && section.histogram[numBuckets-1] == 0){
+				numBuckets--;
+			}
+			for(int b = 0; b < numBuckets; b++){
+				json << (b > 0 ? "," : "") << section.histogram[b];
+			}
+			json << "]}";
+			first = false;
+		}
+		json << "}}";
+	}
+	json << "]}" << endl;
+	return json.str();
+}
+
+#ifdef OFXTL_PROFILE
+ofxTLProfileScope::ofxTLProfileScope(ofxTLTrack* _track, int _section)
+:	track(_track),
+	section(_section),
+	startAllocations(ofxTLProfiler::getAllocationCount()),
+	start(std::chrono::steady_clock::now())
+{
+
+}
+
+ofxTLProfileScope::~ofxTLProfileScope(){
+	if(track != NULL){
+		unsigned long long micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		track->getProfile().add(section, micros, ofxTLProfiler::getAllocationCount() - startAllocations);
+	}
+}
+#endif
@@ -0,0 +1,121 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include <mutex>
+
+class ofxTLTrack;
+
+//opt-in timing of what each track costs. define OFXTL_PROFILE for the whole project
+//(ADDON_CFLAGS or the IDE's preprocessor flags) to collect it. without it the
+//OFXTL_PROFILE_SCOPE macros compile to nothing and tracks carry no extra state.
+//also defining OFXTL_PROFILE_ALLOCATIONS counts heap allocations by replacing the global operator new
+enum ofxTLProfileSectionType {
+	OFXTL_PROFILE_UPDATE = 0,
+	OFXTL_PROFILE_DRAW,
+	OFXTL_PROFILE_PREVIEWS,
+	OFXTL_PROFILE_SAMPLE,
+	OFXTL_PROFILE_SAVE,
+	OFXTL_PROFILE_LOAD,
+	OFXTL_PROFILE_UNDO,
+	OFXTL_PROFILE_NUM_SECTIONS
+};
+
+//calls are counted in buckets by duration, bucket 0 is under a microsecond
+//and bucket n is 2^(n-1) to 2^n microseconds
+#define OFXTL_PROFILE_BUCKETS 32
+
+class ofxTLProfileSection {
+  public:
+	ofxTLProfileSection();
+	void add(unsigned long long micros, unsigned long long allocations);
+
+	unsigned long long calls;
+	unsigned long long totalMicros;
+	unsigned long long maxMicros;
+	unsigned long long allocations;
+	unsigned long long histogram[OFXTL_PROFILE_BUCKETS];
+};
+
+//what a track collects, sections are written from whichever thread did the work
+class ofxTLTrackProfile {
+  public:
+	void add(int section, unsigned long long micros, unsigned long long allocations);
+	void get(ofxTLProfileSection* sections);
+	void reset();
+
+  protected:
+	std::mutex lock;
+	ofxTLProfileSection sections[OFXTL_PROFILE_NUM_SECTIONS];
+};
+
+class ofxTLTrackStats {
+  public:
+	string name;
+	string type;
+	ofxTLProfileSection sections[OFXTL_PROFILE_NUM_SECTIONS];
+};
+
+class ofxTLProfiler {
+  public:
+	static bool isEnabled();
+	static string getSectionName(int section);
+	//allocations made on this thread so far, always 0 without OFXTL_PROFILE_ALLOCATIONS
+	static unsigned long long getAllocationCount();
+
+	//one row per track and section. the histogram is left out of the csv
+	static string getStatsCSV(const vector<ofxTLTrackStats>& stats);
+	static string getStatsJSON(const vector<ofxTLTrackStats>& stats);
+};
+
+#ifdef OFXTL_PROFILE
+//times the rest of the enclosing block against track, which may be NULL
+class ofxTLProfileScope {
+  public:
+	ofxTLProfileScope(ofxTLTrack* track, int section);
+	~ofxTLProfileScope();
+
+  protected:
+	ofxTLTrack* track;
+	int section;
+	unsigned long long startAllocations;
+	std::chrono::steady_clock::time_point start;
+};
+
+#define OFXTL_PROFILE_CONCAT_(a, b) a##b
+#define OFXTL_PROFILE_CONCAT(a, b) OFXTL_PROFILE_CONCAT_(a, b)
+#define OFXTL_PROFILE_SCOPE(track, section) ofxTLProfileScope OFXTL_PROFILE_CONCAT(profileScope, __LINE__)((track), (section))
+#else
+#define OFXTL_PROFILE_SCOPE(track, section)
+#endif
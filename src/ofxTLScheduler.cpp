@@ -0,0 +1,148 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLScheduler.h"
+#include "ofxTimeline.h"
+
+ofxTLScheduler::ofxTLScheduler()
+:	wakeRequested(false)
+{
+	//thread starts with the first timeline
+}
+
+ofxTLScheduler::~ofxTLScheduler(){
+	if(isThreadRunning()){
+		stopThread();
+		wake();
+		waitForThread(false);
+	}
+	//anything still attached goes back to updating with the app
+	vector<ofxTimeline*> attached = getTimelines();
+	for(int i = 0; i < attached.size(); i++){
+		attached[i]->removeFromThread();
+	}
+}
+
+void ofxTLScheduler::addTimeline(ofxTimeline* timeline){
+	{
+		std::unique_lock<std::recursive_mutex> lock(timelinesLock);
+		if(find(timelines.begin(), timelines.end(), timeline) != timelines.end()){
+			return;
+		}
+		timelines.push_back(timeline);
+	}
+
+	if(!isThreadRunning()){
+		startThread();
+	}
+	wake();
+}
+
+void ofxTLScheduler::removeTimeline(ofxTimeline* timeline){
+	std::unique_lock<std::recursive_mutex> lock(timelinesLock);
+	vector<ofxTimeline*>::iterator it = find(timelines.begin(), timelines.end(), timeline);
+	if(it != timelines.end()){
+		timelines.erase(it);
+	}
+}
+
+vector<ofxTimeline*> ofxTLScheduler::getTimelines(){
+	std::unique_lock<std::recursive_mutex> lock(timelinesLock);
+	return timelines;
+}
+
+void ofxTLScheduler::play(){
+	std::unique_lock<std::recursive_mutex> lock(timelinesLock);
+	for(int i = 0; i < timelines.size(); i++){
+		timelines[i]->play();
+	}
+	//holding the lock keeps the thread from updating in between,
+	//so lining every start up on one reading puts them on the same sample
+	long long now = timer.getAppTimeMicros();
+	for(int i = 0; i < timelines.size(); i++){
+		if(timelines[i]->getIsPlaying()){
+			timelines[i]->syncPlaybackStart(now);
+		}
+	}
+}
+
+void ofxTLScheduler::stop(){
+	std::unique_lock<std::recursive_mutex> lock(timelinesLock);
+	long long now = timer.getAppTimeMicros();
+	for(int i = 0; i < timelines.size(); i++){
+		if(timelines[i]->getIsPlaying()){
+			timelines[i]->stopAt(now);
+		}
+	}
+}
+
+ofxMSATimer& ofxTLScheduler::getTimer(){
+	return timer;
+}
+
+void ofxTLScheduler::wake(){
+	std::unique_lock<std::mutex> lock(wakeLock);
+	wakeRequested = true;
+	wakeCondition.notify_all();
+}
+
+void ofxTLScheduler::threadedFunction(){
+	while(isThreadRunning()){
+		long long wakeMicros = -1;
+		{
+			std::unique_lock<std::recursive_mutex> lock(timelinesLock);
+			for(int i = 0; i < timelines.size(); i++){
+				timelines[i]->updateTime();
+			}
+			for(int i = 0; i < timelines.size(); i++){
+				long long timelineWake = timelines[i]->getNextWakeMicros();
+				if(timelineWake >= 0){
+					wakeMicros = wakeMicros < 0 ? timelineWake : MIN(wakeMicros, timelineWake);
+				}
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(wakeLock);
+		if(!wakeRequested && isThreadRunning()){
+			if(wakeMicros < 0){
+				wakeCondition.wait(lock, [this]{ return wakeRequested; });
+			}
+			else{
+				long long sleepMicros = wakeMicros - (long long)timer.getAppTimeMicros();
+				if(sleepMicros > 0){
+					wakeCondition.wait_for(lock, std::chrono::microseconds(sleepMicros), [this]{ return wakeRequested; });
+				}
+			}
+		}
+		wakeRequested = false;
+	}
+}
@@ -0,0 +1,84 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxMSATimer.h"
+#include <condition_variable>
+
+//runs any number of timelines off one clock and one thread.
+//each timeline keeps its own playback, loop and in/out settings,
+//the scheduler just decides when to wake up and update them.
+//
+//  ofxTLScheduler scheduler;
+//  timelineA.moveToScheduler(&scheduler);
+//  timelineB.moveToScheduler(&scheduler);
+//  scheduler.play(); //both start on the same clock reading
+//
+//don't add or remove timelines from inside a timeline event listener
+class ofxTimeline;
+class ofxTLScheduler : ofThread {
+  public:
+	ofxTLScheduler();
+	virtual ~ofxTLScheduler();
+
+	//called by ofxTimeline::moveToScheduler() and removeFromThread()
+	void addTimeline(ofxTimeline* timeline);
+	void removeTimeline(ofxTimeline* timeline);
+	vector<ofxTimeline*> getTimelines();
+
+	//starts or stops every timeline against the same clock reading
+	//so they stay aligned with each other
+	void play();
+	void stop();
+
+	//the clock shared by every timeline on this scheduler
+	ofxMSATimer& getTimer();
+
+	//wakes the thread to reschedule, timelines call this on play, stop, seek and edits
+	void wake();
+
+  protected:
+	ofxMSATimer timer;
+
+	//timeline events fire from updates with this held, it's recursive so
+	//a listener on the scheduler thread can still call play() or stop()
+	std::recursive_mutex timelinesLock;
+	vector<ofxTimeline*> timelines;
+
+	std::mutex wakeLock;
+	std::condition_variable wakeCondition;
+	bool wakeRequested;
+
+	virtual void threadedFunction();
+};
@@ -35,7 +35,7 @@
 
 ofxTLSwitches::ofxTLSwitches(){
 	placingSwitch = NULL;
-    lastTimelinePoint = 0;
+    lastTimelinePoint = -1;
     enteringText = false;
 	clickedTextField = NULL;
 }
@@ -44,29 +44,41 @@ ofxTLSwitches::~ofxTLSwitches(){
     
 }
 
+void ofxTLSwitches::playbackStarted(ofxTLPlaybackEventArgs& args){
+	ofxTLKeyframes::playbackStarted(args);
+	lastTimelinePoint = (long long)currentTrackTime() - 1;
+}
+
+void ofxTLSwitches::playbackLooped(ofxTLPlaybackEventArgs& args){
+	lastTimelinePoint = -1;
+}
+
 void ofxTLSwitches::update(){
-    long thisTimelinePoint = currentTrackTime();
-    for(int i = 0; i < keyframes.size(); i++){
-        ofxTLSwitch* switchKey = (ofxTLSwitch*)keyframes[i];
+    //edges fire once when the playhead moves past them, like bangs
+    long long thisTimelinePoint = currentTrackTime();
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+    for(int i = 0; i < keys.size(); i++){
+        ofxTLSwitch* switchKey = (ofxTLSwitch*)keys[i];
         
         // switch turns on
         if(timeline->getInOutRangeMillis().contains(switchKey->time) &&
-           lastTimelinePoint <= switchKey->time &&
-           thisTimelinePoint >= switchKey->time &&
+           lastTimelinePoint < (long long)switchKey->time &&
+           thisTimelinePoint >= (long long)switchKey->time &&
            thisTimelinePoint != lastTimelinePoint)
         {
-            switchStateChanged(keyframes[i]);
+            switchStateChanged(keys[i]);
         }
         
         // switch turns off
         if(timeline->getInOutRangeMillis().contains(switchKey->timeRange.max) &&
-           lastTimelinePoint <= switchKey->timeRange.max &&
+           lastTimelinePoint < switchKey->timeRange.max &&
            thisTimelinePoint >= switchKey->timeRange.max &&
            thisTimelinePoint != lastTimelinePoint)
         {
-            switchStateChanged(keyframes[i]);
+            switchStateChanged(keys[i]);
         }
     }
+    endPlaybackRead();
     lastTimelinePoint = thisTimelinePoint;
 }
 
@@ -76,7 +88,7 @@ void ofxTLSwitches::switchStateChanged(ofxTLKeyframe* key){
     args.track = this;
     args.on = isOn();
     //args.switchName = ((ofxTLSwitch*)key)->textField.text;
-    ofNotifyEvent(events().switched, args);
+    notify([this, args]() mutable { ofNotifyEvent(events().switched, args); });
 }
 
 void ofxTLSwitches::draw(){
@@ -189,16 +201,19 @@ void ofxTLSwitches::draw(){
 }
 
 bool ofxTLSwitches::isOnAtMillis(long millis){
-    for(int i = 0; i < keyframes.size(); i++){
-        ofxTLSwitch* switchKey = (ofxTLSwitch*)keyframes[i];
-        if(switchKey->timeRange.min > millis){
-            break;
-        }
-        if(switchKey->timeRange.contains(millis)){
-            return true;
-        }
-    }
-    return false;    
+    OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_SAMPLE);
+    ofxTLKeyframeSnapshot* snapshot;
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead(snapshot);
+    bool on = switchIsOnAtMillis<ofxTLSwitch>(keys, snapshot, millis);
+    endPlaybackRead();
+    return on;
+}
+
+void ofxTLSwitches::sampleOnAtMillis(const vector<unsigned long long>& millis, float* values){
+    OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_SAMPLE);
+    vector<ofxTLKeyframe*>& keys = beginPlaybackRead();
+    sampleSwitchesAtMillis<ofxTLSwitch>(keys, millis, values);
+    endPlaybackRead();
 }
 
 bool ofxTLSwitches::isOn(){
@@ -395,18 +410,24 @@ void ofxTLSwitches::mouseDragged(ofMouseEventArgs& args, long millis){
 		//look for any keys with just beginning and ends selected
 		//becaues of the logical in the mousePressed, there will never
 		//be a selected keyframe with an end selected
+		bool draggedEdge = false;
 		for(int i = 0; i < keyframes.size(); i++){
 			ofxTLSwitch* switchKey = (ofxTLSwitch*)keyframes[i];
 			if(switchKey->startSelected){
 				switchKey->timeRange.min = millis - switchKey->edgeDragOffset;
 				switchKey->time = switchKey->timeRange.min;
+				draggedEdge = true;
 			}
 			else if(switchKey->endSelected){
 				switchKey->timeRange.max = millis - switchKey->edgeDragOffset;
+				draggedEdge = true;
 			}
 		}
 		
 		updateTimeRanges();
+		if(draggedEdge){
+			markChanged();
+		}
 	}
 }
 
@@ -542,6 +563,34 @@ void ofxTLSwitches::regionSelected(ofLongRange timeRange, ofRange valueRange){
     }
 }
 
+bool ofxTLSwitches::updateSnapIndex(vector<unsigned long long>& index){
+	index.reserve(keyframes.size()*2);
+	for(int i = 0; i < keyframes.size(); i++){
+        ofxTLSwitch* switchKey = (ofxTLSwitch*)keyframes[i];
+		index.push_back(switchKey->timeRange.min);
+		index.push_back(switchKey->timeRange.max);
+	}
+	sort(index.begin(), index.end());
+	index.erase(unique(index.begin(), index.end()), index.end());
+	return true;
+}
+
+void ofxTLSwitches::getSelectedSnappingPoints(vector<unsigned long long>& points){
+	for(int i = 0; i < selectedKeyframes.size(); i++){
+        ofxTLSwitch* switchKey = (ofxTLSwitch*)selectedKeyframes[i];
+		points.push_back(switchKey->timeRange.min);
+		points.push_back(switchKey->timeRange.max);
+	}
+	//dragging just one edge doesn't select the key
+	for(int i = 0; i < keyframes.size(); i++){
+        ofxTLSwitch* switchKey = (ofxTLSwitch*)keyframes[i];
+		if(switchKey->startSelected || switchKey->endSelected){
+			points.push_back(switchKey->timeRange.min);
+			points.push_back(switchKey->timeRange.max);
+		}
+	}
+}
+
 void ofxTLSwitches::getSnappingPoints(std::set<unsigned long long>& points){
 	for(int i = 0; i < keyframes.size(); i++){
         ofxTLSwitch* switchKey = (ofxTLSwitch*)keyframes[i];
@@ -553,6 +602,18 @@ void ofxTLSwitches::getSnappingPoints(std::set<unsigned long long>& points){
 	}
 }
 
+unsigned long long ofxTLSwitches::getNextEventTime(unsigned long long millis){
+	ofxTLKeyframeSnapshot* snapshot;
+	vector<ofxTLKeyframe*>& keys = beginPlaybackRead(snapshot);
+	unsigned long long next = nextSwitchEdge<ofxTLSwitch>(keys, snapshot, millis);
+	endPlaybackRead();
+	return next;
+}
+
+void ofxTLSwitches::indexPlaybackKeys(ofxTLKeyframeSnapshot* snapshot){
+	indexRangeEnds<ofxTLSwitch>(snapshot);
+}
+
 int ofxTLSwitches::getSelectedItemCount(){
 	int numEdgesSelected = 0;
 	for(int i = 0; i < keyframes.size(); i++){
@@ -585,14 +646,21 @@ ofxTLKeyframe* ofxTLSwitches::newKeyframe(){
     return switchKey;
 }
 
-void ofxTLSwitches::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
+ofxTLKeyframe* ofxTLSwitches::copyKeyframe(ofxTLKeyframe* key){
+	if(typeid(*key) == typeid(ofxTLSwitch)){
+		return new ofxTLSwitch(*(ofxTLSwitch*)key);
+	}
+	return NULL;
+}
+
+void ofxTLSwitches::restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags){
     //pull the saved time into min, and our custom max value
     ofxTLSwitch* switchKey = (ofxTLSwitch*)key;
-    //switchKey->textField.text = xmlStore.getValue("switchName", "");
+    //switchKey->textField.text = keyTags.getValue("switchName", "");
 
     switchKey->timeRange.min = switchKey->time;
     //
-    string timecode = xmlStore.getValue("max", "00:00:00:000");
+    string timecode = keyTags.getValue("max", "00:00:00:000");
     if(timecode.find(":") == string::npos){
         switchKey->timeRange.max = ofToFloat(timecode) * timeline->getDurationInMilliseconds(); //Legacy max of 0-1
     }
@@ -604,6 +672,10 @@ void ofxTLSwitches::restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore
 	
 	//a bit of a hack, but if 
 	placingSwitch = NULL;
+	//subclasses that read their own tags in restoreKeyframe still get them
+	if(typeid(*this) != typeid(ofxTLSwitches)){
+		ofxTLKeyframes::restoreKeyframeTags(key, keyTags);
+	}
 }
 
 void ofxTLSwitches::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
@@ -614,6 +686,33 @@ void ofxTLSwitches::storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore){
 	xmlStore.addValue("max", timeline->getTimecode().timecodeForMillis(switchKey->timeRange.max));
 }
 
+bool ofxTLSwitches::storeKeyframeBinary(ofxTLKeyframe* key, string& buffer){
+	if(typeid(*key) != typeid(ofxTLSwitch)){
+		return false;
+	}
+    ofxTLSwitch* switchKey = (ofxTLSwitch* )key;
+    appendBinary(buffer, switchKey->timeRange.min);
+    appendBinary(buffer, switchKey->timeRange.max);
+	return true;
+}
+
+void ofxTLSwitches::restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer){
+    ofxTLSwitch* switchKey = (ofxTLSwitch*)key;
+    readBinary(buffer, switchKey->timeRange.min);
+    readBinary(buffer, switchKey->timeRange.max);
+    switchKey->time = switchKey->previousTime = switchKey->timeRange.min;
+    switchKey->startSelected = switchKey->endSelected = false;
+	placingSwitch = NULL;
+}
+
+void ofxTLSwitches::restorePastedKeyframe(ofxTLKeyframe* key){
+    //newKeyframe started it at the mouse, the pasted key starts and ends at its time
+    ofxTLSwitch* switchKey = (ofxTLSwitch*)key;
+    switchKey->timeRange.min = switchKey->timeRange.max = switchKey->time;
+    switchKey->startSelected = switchKey->endSelected = false;
+	placingSwitch = NULL;
+}
+
 void ofxTLSwitches::willDeleteKeyframe(ofxTLKeyframe* keyframe){
     /*ofxTLSwitch* switchKey = (ofxTLSwitch* )keyframe;
     if(switchKey->textField.getIsEditing()){
@@ -55,9 +55,15 @@ class ofxTLSwitches : public ofxTLKeyframes {
 
     virtual void draw();
 
+	virtual void playbackStarted(ofxTLPlaybackEventArgs& args);
+	virtual void playbackLooped(ofxTLPlaybackEventArgs& args);
+
 	virtual bool isOn();
     virtual bool isOnAtMillis(long millis);
     virtual bool isOnAtPercent(float percent);
+    //1 or 0 for each of millis, which have to be in order. one pass over the
+    //switches for all of them, rather than a search for each like isOnAtMillis
+    virtual void sampleOnAtMillis(const vector<unsigned long long>& millis, float* values);
     
     ofxTLSwitch* getActiveSwitchAtMillis(long millis);
     
@@ -69,6 +75,9 @@ class ofxTLSwitches : public ofxTLKeyframes {
     virtual void keyPressed(ofKeyEventArgs& args);
     
     virtual void getSnappingPoints(std::set<unsigned long long>& points);
+    virtual bool updateSnapIndex(vector<unsigned long long>& index);
+    virtual void getSelectedSnappingPoints(vector<unsigned long long>& points);
+    virtual unsigned long long getNextEventTime(unsigned long long millis);
     virtual void regionSelected(ofLongRange timeRange, ofRange valueRange);
 
     virtual void unselectAll();
@@ -82,8 +91,12 @@ class ofxTLSwitches : public ofxTLKeyframes {
     virtual void willDeleteKeyframe(ofxTLKeyframe* keyframe);
     
     virtual ofxTLKeyframe* newKeyframe();
-    virtual void restoreKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+    virtual ofxTLKeyframe* copyKeyframe(ofxTLKeyframe* key);
+    virtual void restoreKeyframeTags(ofxTLKeyframe* key, ofxTLXMLKeyReader& keyTags);
 	virtual void storeKeyframe(ofxTLKeyframe* key, ofxXmlSettings& xmlStore);
+	virtual bool storeKeyframeBinary(ofxTLKeyframe* key, string& buffer);
+	virtual void restoreKeyframeBinary(ofxTLKeyframe* key, const char*& buffer);
+	virtual void restorePastedKeyframe(ofxTLKeyframe* key);
 	virtual ofxTLKeyframe* keyframeAtScreenpoint(ofVec2f p);
     virtual void updateEdgeDragOffsets(long clickMillis);
 	virtual int getSelectedItemCount();
@@ -91,8 +104,85 @@ class ofxTLSwitches : public ofxTLKeyframes {
 
 	//pushes any edits from keyframes superclass into the switches system
 	virtual void updateTimeRanges();
-	
-    long lastTimelinePoint;
+
+	//switches are sorted by start, the running max of their ends in rangeEnds
+	//lets playback skip every switch that is over without looking at it.
+	//notes have their own range, so these are shared through the key type
+	virtual void indexPlaybackKeys(ofxTLKeyframeSnapshot* snapshot);
+	template<class SwitchType> static void indexRangeEnds(ofxTLKeyframeSnapshot* snapshot){
+		snapshot->rangeEnds.resize(snapshot->keyframes.size());
+		unsigned long long latestEnd = 0;
+		for(int i = 0; i < snapshot->keyframes.size(); i++){
+			latestEnd = MAX(latestEnd, (unsigned long long)((SwitchType*)snapshot->keyframes[i])->timeRange.max);
+			snapshot->rangeEnds[i] = latestEnd;
+		}
+	}
+	//the number of switches starting at or before millis
+	template<class SwitchType> static int countStartedSwitches(vector<ofxTLKeyframe*>& keys, long millis){
+		int low = 0;
+		int high = keys.size();
+		while(low < high){
+			int mid = (low + high) / 2;
+			if(((SwitchType*)keys[mid])->timeRange.min <= millis){
+				low = mid + 1;
+			}
+			else{
+				high = mid;
+			}
+		}
+		return low;
+	}
+	//without a snapshot the live keys aren't indexed and every switch is checked
+	template<class SwitchType> static bool switchIsOnAtMillis(vector<ofxTLKeyframe*>& keys, ofxTLKeyframeSnapshot* snapshot, long millis){
+		if(snapshot == NULL){
+			for(int i = 0; i < keys.size(); i++){
+				if(((SwitchType*)keys[i])->timeRange.contains(millis)){
+					return true;
+				}
+			}
+			return false;
+		}
+		int started = countStartedSwitches<SwitchType>(keys, millis);
+		return millis >= 0 && started > 0 && snapshot->rangeEnds[started-1] >= (unsigned long long)millis;
+	}
+	//a switch that has started is on until the latest end of any started so far
+	template<class SwitchType> static void sampleSwitchesAtMillis(vector<ofxTLKeyframe*>& keys, const vector<unsigned long long>& millis, float* values){
+		int started = 0;
+		unsigned long long latestEnd = 0;
+		for(int i = 0; i < millis.size(); i++){
+			while(started < keys.size() && ((SwitchType*)keys[started])->timeRange.min <= (long long)millis[i]){
+				latestEnd = MAX(latestEnd, (unsigned long long)((SwitchType*)keys[started])->timeRange.max);
+				started++;
+			}
+			values[i] = started > 0 && latestEnd >= millis[i] ? 1.0 : 0.0;
+		}
+	}
+	template<class SwitchType> static unsigned long long nextSwitchEdge(vector<ofxTLKeyframe*>& keys, ofxTLKeyframeSnapshot* snapshot, unsigned long long millis){
+		unsigned long long next = ULLONG_MAX;
+		int first = 0;
+		int started = keys.size();
+		if(snapshot != NULL){
+			started = countStartedSwitches<SwitchType>(keys, millis);
+			if(started < keys.size()){
+				next = ((SwitchType*)keys[started])->timeRange.min;
+			}
+			//everything before the first running end past millis is already over
+			first = upper_bound(snapshot->rangeEnds.begin(), snapshot->rangeEnds.begin() + started, millis) - snapshot->rangeEnds.begin();
+		}
+		for(int i = first; i < started; i++){
+			SwitchType* switchKey = (SwitchType*)keys[i];
+			if(switchKey->timeRange.min > millis){
+				next = MIN(next, (unsigned long long)switchKey->timeRange.min);
+			}
+			else if(switchKey->timeRange.max > millis){
+				next = MIN(next, (unsigned long long)switchKey->timeRange.max);
+			}
+		}
+		return next;
+	}
+
+    //signed so -1 can mean before the first edge, edge times are compared as long long
+    long long lastTimelinePoint;
     bool startHover;
     bool endHover;
     ofxTLSwitch* placingSwitch;
@@ -36,7 +36,11 @@
 ofxTLTicker::ofxTLTicker() {
 	dragging = false;
     hasBPM = false;
+    bpm = 120;
     drawBPMGrid = false;
+    bpmPointsDirty = true;
+    bpmPointsDuration = 0;
+    tickMarksDuration = 0;
 	hoverTime = 0;
     playOnMouseReleased = false;
 }
@@ -61,7 +65,7 @@ void ofxTLTicker::draw(){
     float durationInview = endTime-startTime;
     float secondsPerPixel = durationInview / bounds.width;
     
-	if(viewIsDirty){
+	if(viewIsDirty || tickMarksDuration != timeline->getDurationInMilliseconds()){
 		refreshTickMarks();
 	}
 	
@@ -71,9 +75,7 @@ void ofxTLTicker::draw(){
 
 		
     if(drawBPMGrid){
-		if(viewIsDirty){
-	        updateBPMPoints();
-		}
+        updateBPMPoints();
         ofPushStyle();
         ofSetColor(255, 255, 255, 50);
         for(int i = 0; i < bpmScreenPoints.size(); i++){
@@ -172,20 +174,76 @@ void ofxTLTicker::setHoverTime(unsigned long long millis){
 void ofxTLTicker::setBPM(float newBpm){
 	bpm = newBpm;
 	hasBPM = true;
+	bpmPointsDirty = true;
 }
 
 float ofxTLTicker::getBPM(){
 	return bpm;
 }
 
+void ofxTLTicker::addTempoChange(unsigned long long millis, float newBpm){
+	if(newBpm <= 0){
+		ofLogError("ofxTLTicker::addTempoChange") << "BPM must be positive, got " << newBpm;
+		return;
+	}
+	if(millis == 0){
+		setBPM(newBpm);
+		return;
+	}
+	ofxTLTempoChange change;
+	change.millis = millis;
+	change.bpm = newBpm;
+	int index = getTempoIndex(millis);
+	if(index >= 0 && tempoChanges[index].millis == millis){
+		tempoChanges[index] = change;
+	}
+	else{
+		tempoChanges.insert(tempoChanges.begin() + (index + 1), change);
+	}
+	bpmPointsDirty = true;
+}
+
+void ofxTLTicker::clearTempoChanges(){
+	tempoChanges.clear();
+	bpmPointsDirty = true;
+}
+
+const vector<ofxTLTempoChange>& ofxTLTicker::getTempoChanges(){
+	return tempoChanges;
+}
+
+//index of the last change at or before millis, -1 for the starting tempo
+int ofxTLTicker::getTempoIndex(unsigned long long millis){
+	int low = 0;
+	int high = tempoChanges.size();
+	while(low < high){
+		int mid = (low + high) / 2;
+		if(tempoChanges[mid].millis <= millis){
+			low = mid + 1;
+		}
+		else{
+			high = mid;
+		}
+	}
+	return low - 1;
+}
+
+float ofxTLTicker::getBPMAtMillis(unsigned long long millis){
+	int index = getTempoIndex(millis);
+	return index < 0 ? bpm : tempoChanges[index].bpm;
+}
+
+unsigned long long ofxTLTicker::getTempoStartMillis(unsigned long long millis){
+	int index = getTempoIndex(millis);
+	return index < 0 ? 0 : tempoChanges[index].millis;
+}
+
 //250 bpm = 250/60 beats per second
 //1 beat = 1/(250/60) seconds
 //1/2 beat = (1/(250/60))/2 seconds = 0.12 seconds
 void ofxTLTicker::getSnappingPoints(std::set<unsigned long long>& points){
 
-	if(!drawBPMGrid){
-		updateBPMPoints();
-	}
+	updateBPMPoints();
     
 	for(int i = 0; i < bpmScreenPoints.size(); i++){
 		points.insert(bpmScreenPoints[i].millis);
@@ -194,8 +252,23 @@ void ofxTLTicker::getSnappingPoints(std::set<unsigned long long>& points){
 	points.insert(timeline->getCurrentTimeMillis());
 }
 
+bool ofxTLTicker::updateSnapIndex(vector<unsigned long long>& index){
+	updateBPMPoints();
+	index.reserve(bpmScreenPoints.size() + 1);
+	for(int i = 0; i < bpmScreenPoints.size(); i++){
+		index.push_back(bpmScreenPoints[i].millis);
+	}
+	unsigned long long playhead = timeline->getCurrentTimeMillis();
+	if(!binary_search(index.begin(), index.end(), playhead)){
+		index.insert(upper_bound(index.begin(), index.end(), playhead), playhead);
+	}
+	//the playhead moves without telling us
+	return false;
+}
+
 void ofxTLTicker::refreshTickMarks(){
 	tickerMarks.clear();
+	tickMarksDuration = timeline->getDurationInMilliseconds();
 
     unsigned long long startMillis = zoomBounds.min * timeline->getDurationInMilliseconds();
     unsigned long long endMillis = zoomBounds.max * timeline->getDurationInMilliseconds();
@@ -236,14 +309,14 @@ void ofxTLTicker::refreshTickMarks(){
     showFrames = false;
 	
 	unsigned long long lastMillis = screenXToMillis(bounds.x);
-    int lastFrame = lastMillis/(1000/timeline->getTimecode().getFPS());
+    int lastFrame = timeline->getTimecode().frameForMillis(lastMillis);
 	int lastSecond = lastMillis/1000;
 	int lastMinute = lastSecond/60;
 	int lastHour = lastMinute/60;
 	for(int i = bounds.getMinX()+step; i < bounds.getMaxX(); i+=step){
 		int height = 0;
 		unsigned long long currentMillis = screenXToMillis(i);
-        int currentFrame = currentMillis/(1000/timeline->getTimecode().getFPS());
+        int currentFrame = timeline->getTimecode().frameForMillis(currentMillis);
 		int currentSecond = currentMillis/1000;
 		int currentMinute = currentSecond/60;
 		int currentHour = currentMinute/60;
@@ -257,7 +330,7 @@ void ofxTLTicker::refreshTickMarks(){
         if(showFrames && currentFrame > lastFrame){
             height = bounds.height*.25;
             lastFrame = currentFrame;
-            x = millisToScreenX(lastFrame*(1000/timeline->getTimecode().getFPS()));
+            x = millisToScreenX(timeline->getTimecode().millisForFrame(lastFrame));
         }
 
 		if(showSeconds && currentSecond > lastSecond){
@@ -286,63 +359,61 @@ void ofxTLTicker::refreshTickMarks(){
 
 }
 
-//TODO: find a way to make this not happen every frame
+//only the visible part of the grid is built, and only when the view or tempo changes
 void ofxTLTicker::updateBPMPoints(){
-	
+	unsigned long long duration = timeline->getDurationInMilliseconds();
+	if(!bpmPointsDirty && bpmPointsDuration == duration && bpmPointsBounds == bounds &&
+	   bpmPointsZoom.min == zoomBounds.min && bpmPointsZoom.max == zoomBounds.max){
+		return;
+	}
+	bpmPointsDirty = false;
+	bpmPointsDuration = duration;
+	bpmPointsBounds = bounds;
+	bpmPointsZoom = zoomBounds;
+
 	bpmScreenPoints.clear();
 
-	double currentPoint = 0;
-	double oneMeasure = 1.0/(bpm/60.);
-	double halfMeasure = oneMeasure/2;
-	double quarterMeasure = halfMeasure/2;
-
-    bool showMeasure = true;
-    bool showHalfMeasure = false;
-    bool showQuarterMeasure = false;
-	showMeasure = screenXForTime(oneMeasure) - screenXForTime(0) > 20;
-	if(showMeasure){
-		showHalfMeasure = screenXForTime(halfMeasure) - screenXForTime(0) > 20;
-		if (showHalfMeasure) {
-			showQuarterMeasure = screenXForTime(halfMeasure) - screenXForTime(0) > 20;
+	unsigned long long visibleStart = zoomBounds.min * duration;
+	unsigned long long visibleEnd = MIN((unsigned long long)(zoomBounds.max * duration), duration);
+	for(int i = getTempoIndex(visibleStart); i < (int)tempoChanges.size(); i++){
+		unsigned long long segmentStart = i < 0 ? 0 : tempoChanges[i].millis;
+		if(segmentStart > visibleEnd){
+			break;
 		}
+		unsigned long long segmentEnd = i+1 < tempoChanges.size() ? tempoChanges[i+1].millis : duration;
+		addBPMPoints(segmentStart, segmentEnd, i < 0 ? bpm : tempoChanges[i].bpm, visibleStart, visibleEnd);
 	}
+}
 
-	int currentMeasure = 0;        
-	while(currentPoint < timeline->getDurationInSeconds()){
-		ofxTLBPMPoint measures[4];
-		int numMeasures = 0;
-		if(showMeasure){
-			measures[0].millis = currentPoint * 1000;
-			measures[0].screenX = millisToScreenX(measures[0].millis);
-			measures[0].weight = 4;
-			numMeasures = 1;
-		}
-		if(showHalfMeasure){
-			measures[1].millis = (currentPoint+halfMeasure) * 1000;
-			measures[1].screenX = millisToScreenX(measures[1].millis);
-			measures[1].weight = 2;
-			numMeasures = 2;
-		}
-		if(showQuarterMeasure){
-			measures[2].millis = (currentPoint+quarterMeasure) * 1000;
-			measures[2].screenX = millisToScreenX(measures[2].millis);
-			measures[2].weight = 1;
-			measures[3].millis = (currentPoint+halfMeasure+quarterMeasure) * 1000;
-			measures[3].screenX = millisToScreenX(measures[3].millis);
-			measures[3].weight = 1;
-			numMeasures = 4;
-		}
-		
-		for(int m = 0; m < numMeasures; m++){
-			if( isOnScreen(measures[m].screenX) ){
-				bpmScreenPoints.push_back( measures[m] );
-			}
-		}
+void ofxTLTicker::addBPMPoints(unsigned long long segmentStart, unsigned long long segmentEnd, float segmentBPM,
+							   unsigned long long visibleStart, unsigned long long visibleEnd){
+	if(segmentBPM <= 0){
+		return;
+	}
+	double oneMeasure = 60000. / segmentBPM; //in millis
 
-		currentMeasure++;
-		currentPoint = currentMeasure*oneMeasure;
+	//split measures in halves and quarters while they are far enough apart
+	int subdivisions = 0;
+	float measureWidth = millisToScreenX(segmentStart + oneMeasure) - millisToScreenX(segmentStart);
+	while(subdivisions < 4 && measureWidth / MAX(subdivisions*2, 1) > 20){
+		subdivisions = MAX(subdivisions*2, 1);
+	}
+	if(subdivisions == 0){
+		return;
 	}
 
+	double step = oneMeasure / subdivisions;
+	unsigned long long firstMillis = MAX(segmentStart, visibleStart);
+	for(long long k = ceil((firstMillis - segmentStart) / step); ; k++){
+		ofxTLBPMPoint point;
+		point.millis = segmentStart + (unsigned long long)(k * step);
+		if(point.millis >= segmentEnd || point.millis > visibleEnd){
+			break;
+		}
+		point.screenX = millisToScreenX(point.millis);
+		point.weight = k % subdivisions == 0 ? 4 : (k*2) % subdivisions == 0 ? 2 : 1;
+		bpmScreenPoints.push_back(point);
+	}
 }
 
 bool ofxTLTicker::getIsScrubbing(){
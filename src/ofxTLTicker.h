@@ -41,6 +41,11 @@ typedef struct{
 	int weight;
 } ofxTLBPMPoint;
 
+typedef struct{
+	unsigned long long millis;
+	float bpm;
+} ofxTLTempoChange;
+
 class ofxTLTicker : public ofxTLTrack
 {
   public:
@@ -60,7 +65,16 @@ class ofxTLTicker : public ofxTLTrack
 	virtual float getBPM();
 	virtual void setBPM(float bpm);
     
+	//tempo maps, the grid starts again on the beat at each change.
+	//setBPM is the tempo from the start until the first change
+	virtual void addTempoChange(unsigned long long millis, float bpm);
+	virtual void clearTempoChanges();
+	const vector<ofxTLTempoChange>& getTempoChanges();
+	float getBPMAtMillis(unsigned long long millis);
+	unsigned long long getTempoStartMillis(unsigned long long millis);
+    
 	virtual void getSnappingPoints(std::set<unsigned long long>& points);
+	virtual bool updateSnapIndex(vector<unsigned long long>& index);
 	virtual bool getDrawBPMGrid();
 	virtual void setDrawBPMGrid(bool drawGrid);
 	virtual void setHoverTime(unsigned long long millis);
@@ -70,9 +84,19 @@ class ofxTLTicker : public ofxTLTrack
   protected:
 	void updateTimelinePosition();
 	void updateBPMPoints();
+	void addBPMPoints(unsigned long long segmentStart, unsigned long long segmentEnd, float segmentBPM,
+					  unsigned long long visibleStart, unsigned long long visibleEnd);
+	int getTempoIndex(unsigned long long millis);
 
 	ofRectangle totalDrawRect;
 	vector<ofxTLBPMPoint> bpmScreenPoints;
+	vector<ofxTLTempoChange> tempoChanges;
+	//the grid is only rebuilt when one of these changes
+	bool bpmPointsDirty;
+	ofRange bpmPointsZoom;
+	ofRectangle bpmPointsBounds;
+	unsigned long long bpmPointsDuration;
+	unsigned long long tickMarksDuration;
     unsigned long long hoverTime;
 	bool hasBPM;
 	float bpm;
@@ -43,8 +43,15 @@ ofxTLTrack::ofxTLTrack()
 	hover(false),
 	createdByTimeline(false),
     timeline(nullptr),
-	playbackStartTime(0),
-	isPlaying(false)
+	playbackStartMicros(0),
+	currentTimeMicros(0),
+	currentTime(0),
+	isPlaying(false),
+	deferNotifications(false),
+	editDepth(0),
+	mouseEditOpen(false),
+	unpublishedChanges(false),
+	snapIndexDirty(true)
 {
 
 }
@@ -74,6 +81,11 @@ void ofxTLTrack::disable(){
 		focused = false;
 		events().removeZoomEvents(this);
 		events().removePlaybackEvents(this);
+		//no release is coming
+		if(mouseEditOpen){
+			mouseEditOpen = false;
+			endEdit();
+		}
     }
 }
 
@@ -115,6 +127,10 @@ string ofxTLTrack::getName(){
 }
 
 void ofxTLTrack::_draw(){
+	if(timeline->getIsHeadless()){
+		return;
+	}
+
 	ofPushStyle();
 	
 	if(focused){
@@ -134,7 +150,10 @@ void ofxTLTrack::_draw(){
 	ofPopStyle();
 
 	ofPushStyle();
-    draw();
+	{
+		OFXTL_PROFILE_SCOPE(this, OFXTL_PROFILE_DRAW);
+		draw();
+	}
 	ofPopStyle();
 	
 	if(isPlaying){
@@ -151,10 +170,10 @@ void ofxTLTrack::_draw(){
 
 unsigned long long ofxTLTrack::currentTrackTime(){
 	if(isPlaying){
-		currentTime = timeline->getTimer().getAppTimeMillis() - playbackStartTime;
+		currentTimeMicros = timeline->getClockMicros() - playbackStartMicros;
 		checkLoop();
+		currentTime = currentTimeMicros/1000;
 		return currentTime;
-		//return timeline->getInTimeInMillis() + (timeline->getTimer().getAppTimeMillis() - playbackStartTime) % timeline->getInOutRangeMillis().span() ;
 	}
 	else{
 		return timeline->getCurrentTimeMillis();
@@ -162,20 +181,20 @@ unsigned long long ofxTLTrack::currentTrackTime(){
 }
 
 void ofxTLTrack::checkLoop(){
-	if(currentTime < timeline->getInTimeInMillis()){
-        currentTime = timeline->getInTimeInMillis();
-        playbackStartTime = timeline->getTimer().getAppTimeSeconds() - currentTime;
-//        playbackStartFrame = ofGetFrameNum() - timecode.frameForSeconds(currentTime);
+	long long inMicros = timeline->getInTimeInMicros();
+	long long outMicros = timeline->getOutTimeInMicros();
+	if(currentTimeMicros < inMicros){
+        currentTimeMicros = inMicros;
+        playbackStartMicros = timeline->getClockMicros() - currentTimeMicros;
     }
     
-    if(currentTime >= timeline->getOutTimeInMillis()){
+    if(currentTimeMicros >= outMicros){
         if(timeline->getLoopType() == OF_LOOP_NONE){
             stop();
         }
         else if(timeline->getLoopType() == OF_LOOP_NORMAL) {
-            currentTime = timeline->getInTimeInMillis() + (currentTime - timeline->getOutTimeInMillis());
-//            playbackStartFrame += getDurationInFrames()  * inoutRange.span();
-            playbackStartTime  += timeline->getInOutRangeMillis().span();
+            currentTimeMicros = inMicros + (currentTimeMicros - outMicros);
+            playbackStartMicros += outMicros - inMicros;
         }
     }
 }
@@ -192,9 +211,12 @@ bool ofxTLTrack::togglePlay(){
 void ofxTLTrack::play(){
 	if(!isPlaying && !timeline->getIsPlaying()){
 		isPlaying = true;
-		currentTime = ofClamp(timeline->getCurrentTimeMillis(), timeline->getInTimeInMillis(), timeline->getOutTimeInMillis());
-		playbackStartTime = timeline->getTimer().getAppTimeMillis() - currentTime;
+		currentTimeMicros = MAX(timeline->getCurrentTimeMicros(), timeline->getInTimeInMicros());
+		currentTimeMicros = MIN(currentTimeMicros, (long long)timeline->getOutTimeInMicros());
+		playbackStartMicros = timeline->getClockMicros() - currentTimeMicros;
 		checkLoop();
+		currentTime = currentTimeMicros/1000;
+		timeline->wakeThread();
 	}
 }
 
@@ -208,6 +230,24 @@ bool ofxTLTrack::getIsPlaying(){
 	return isPlaying;
 }
 
+long long ofxTLTrack::getSoloWakeMicros(){
+	if(!isPlaying){
+		return -1;
+	}
+	//only reads the clock, looping and stopping are left to update
+	long long inMicros = timeline->getInTimeInMicros();
+	long long nextMicros = timeline->getOutTimeInMicros();
+	long long trackMicros = timeline->getClockMicros() - playbackStartMicros;
+	if(trackMicros >= nextMicros){
+		return playbackStartMicros + nextMicros;
+	}
+	unsigned long long nextMillis = getNextEventTime(MAX(trackMicros, inMicros)/1000);
+	if(nextMillis != ULLONG_MAX){
+		nextMicros = MIN(nextMicros, (long long)nextMillis*1000);
+	}
+	return playbackStartMicros + nextMicros;
+}
+
 void ofxTLTrack::playbackStarted(ofxTLPlaybackEventArgs& args){
 	//we stop playing solo if the main timeline starts
     if(timeline->getTimecontrolTrack() == nullptr || this != timeline->getTimecontrolTrack()){
@@ -218,6 +258,15 @@ void ofxTLTrack::playbackStarted(ofxTLPlaybackEventArgs& args){
 bool ofxTLTrack::_mousePressed(ofMouseEventArgs& args, long millis){
     if(enabled){
 	    active = bounds.inside(args.x, args.y);
+		//a release we never got, publish what the last press and drag did
+		if(mouseEditOpen){
+			mouseEditOpen = false;
+			endEdit();
+		}
+		//the edit stays open through the drag, so a drag publishes once on release
+		//instead of copying every key for playback on each mouse move
+		beginEdit();
+		mouseEditOpen = true;
     	return mousePressed(args, millis);
     }
 	return false;
@@ -232,15 +281,25 @@ void ofxTLTrack::_mouseMoved(ofMouseEventArgs& args, long millis){
 
 void ofxTLTrack::_mouseDragged(ofMouseEventArgs& args, long millis){
     if(enabled){
+		//tracks mark the drags that actually move something
+		beginEdit();
     	mouseDragged(args, millis);
+		endEdit();
     }
 }
 
 void ofxTLTrack::_mouseReleased(ofMouseEventArgs& args, long millis){
     if(enabled){
+		beginEdit();
         mouseReleased(args, millis);
+		endEdit();
 	    active = false;
     }
+	//closed even when disabled since the press, or nothing would publish again
+	if(mouseEditOpen){
+		mouseEditOpen = false;
+		endEdit();
+	}
 }
 
 void ofxTLTrack::gainedFocus(){
@@ -314,6 +373,84 @@ ofxTLEvents& ofxTLTrack::events(){
 	return timeline->events();    
 }
 
+ofxTLUndoDelta* ofxTLTrack::beginUndoDelta(){
+	return new ofxTLXMLUndoDelta(this);
+}
+
+void ofxTLTrack::beginEdit(){
+	editDepth++;
+}
+
+void ofxTLTrack::endEdit(){
+	editDepth = MAX(editDepth-1, 0);
+	if(editDepth == 0){
+		publishPendingChanges();
+	}
+}
+
+void ofxTLTrack::publishPendingChanges(){
+	if(unpublishedChanges){
+		unpublishedChanges = false;
+		publishChanges();
+	}
+}
+
+bool ofxTLTrack::isEditing(){
+	return editDepth > 0;
+}
+
+void ofxTLTrack::markChanged(){
+	snapIndexDirty = true;
+	if(isEditing()){
+		unpublishedChanges = true;
+	}
+	else{
+		//changes from outside a mouse or key event have nobody else to publish them
+		publishChanges();
+	}
+}
+
+const vector<unsigned long long>& ofxTLTrack::getSnapIndex(){
+	if(snapIndexDirty){
+		snapIndex.clear();
+		snapIndexDirty = !updateSnapIndex(snapIndex);
+	}
+	return snapIndex;
+}
+
+bool ofxTLTrack::updateSnapIndex(vector<unsigned long long>& index){
+	std::set<unsigned long long> points;
+	getSnappingPoints(points);
+	index.assign(points.begin(), points.end());
+	return false;
+}
+
+#ifdef OFXTL_PROFILE
+ofxTLTrackProfile& ofxTLTrack::getProfile(){
+	return profile;
+}
+#endif
+
+void ofxTLTrack::setDeferNotifications(bool defer){
+	deferNotifications = defer;
+}
+
+void ofxTLTrack::flushNotifications(){
+	for(int i = 0; i < deferredNotifications.size(); i++){
+		deferredNotifications[i]();
+	}
+	deferredNotifications.clear();
+}
+
+void ofxTLTrack::notify(std::function<void()> notification){
+	if(deferNotifications){
+		deferredNotifications.push_back(notification);
+	}
+	else{
+		notification();
+	}
+}
+
 bool ofxTLTrack::isActive(){
 	return active;    
 }
@@ -37,8 +37,13 @@
 #include "ofxEasing.h"
 #include "ofRange.h"
 #include "ofxTLEvents.h"
+#include "ofxTLProfiler.h"
+#include "ofxTLUndoDelta.h"
+#include "ofxTLAutosaver.h"
+#include "ofxTLLoader.h"
 #include <set>
 #include <climits>
+#include <functional>
 
 #define FOOTER_HEIGHT 6
 #define FOOTER_HEIGHT_RETINA FOOTER_HEIGHT*4
@@ -76,6 +81,9 @@ class ofxTLTrack
 	virtual void stop();
 	virtual bool getIsPlaying();
 	unsigned long long currentTrackTime();
+	//timer micros of the next event or loop while playing solo, -1 when not.
+	//doesn't change playback, so it's safe to call from the timeline thread
+	long long getSoloWakeMicros();
 
     //returns the screenspace position of the elements bounds, not including header and footer
     virtual ofRectangle getDrawRect();
@@ -146,6 +154,22 @@ class ofxTLTrack
     //undo
     virtual string getXMLRepresentation(){return "";};
     virtual void loadFromXMLRepresentation(string rep){};
+	//called before an action that may modify the track. the default stores
+	//the whole xml representation, override to record something smaller
+	virtual ofxTLUndoDelta* beginUndoDelta();
+
+	//autosave. return a job that can write the track's current state from another
+	//thread, the default NULL means autosave calls save() right away instead
+	virtual ofxTLSaveJob* beginBackgroundSave(){ return NULL; };
+
+	//journaling, see ofxTimeline::setUseJournal. startJournal is called when the track's
+	//file is known to match what's in memory, storeJournalChanges then records what
+	//changed since it or since the last call. return false if the track can't do this
+	//and it will be saved whole instead
+	virtual bool startJournal(){ return false; };
+	virtual bool storeJournalChanges(string& removed, string& written){ return false; };
+	//puts back changes read from the journal after a crash
+	virtual bool replayJournalChanges(const string& removed, const string& written){ return false; };
 
 	//zoom events
 	virtual void zoomStarted(ofxTLZoomEventArgs& args);
@@ -157,9 +181,33 @@ class ofxTLTrack
 	virtual void save(){};
 	virtual void load(){};
 	virtual void clear(){};
+	//for loading many tracks at once. return a job that does what load() does, the
+	//default NULL means load() is called on the main thread instead
+	virtual ofxTLLoadJob* beginBackgroundLoad(){ return NULL; };
+	//lazy page loading calls this when the track's page is shown, for tracks
+	//that only loaded what playback needs to load the rest
+	virtual void loadEditorData(){};
 
 	//add any points (in screenspace x) that should be snapped to
 	virtual void getSnappingPoints(std::set<unsigned long long>& points){};
+	//sorted times the page snaps to, kept until the track is changed
+	const vector<unsigned long long>& getSnapIndex();
+	//fills the empty index with every snap time in order. return true if it only changes
+	//with the track, the default asks getSnappingPoints every time since it depends on the selection
+	virtual bool updateSnapIndex(vector<unsigned long long>& index);
+	//times being dragged that shouldn't be snapped to, in any order
+	virtual void getSelectedSnappingPoints(vector<unsigned long long>& points){};
+
+#ifdef OFXTL_PROFILE
+	ofxTLTrackProfile& getProfile();
+#endif
+
+	//tracks that fire events return the first time after millis that one is due,
+	//the threaded timeline sleeps until then. ULLONG_MAX means nothing is coming up
+	virtual unsigned long long getNextEventTime(unsigned long long millis){ return ULLONG_MAX; };
+	//tracks whose value at a time doesn't depend on earlier updates or events can be
+	//sampled from several threads at once, see ofxTLOfflineRenderer
+	virtual bool canRenderInParallel(){ return false; };
 
 	ofxTimeline* getTimeline();
 	//set by the timeline it's self, no need to call this yourself
@@ -176,6 +224,25 @@ class ofxTLTrack
 	void setCreatedByTimeline(bool created);
 	ofxTLEvents& events(); //convenience wrapper for timeline events;
 
+	//when the page updates tracks in parallel it holds back notifications
+	//and flushes them track by track afterwards so listeners are always
+	//called from one thread and in the same order
+	void setDeferNotifications(bool defer);
+	void flushNotifications();
+
+	//edits happen on the GL thread while a threaded timeline plays back.
+	//call markChanged() whenever the track changes. inside begin/endEdit
+	//publishChanges() is called once at the end so the playback side sees
+	//the whole change on its next tick, edits that change nothing cost nothing.
+	//a mouse press, its drags and its release are one edit, playback sees a drag once it's let go
+	void beginEdit();
+	void endEdit();
+	bool isEditing();
+	void markChanged();
+	virtual void publishChanges(){};
+	//publishes now rather than at endEdit, for when something needs the latest state mid edit
+	void publishPendingChanges();
+
   protected:
 
 	ofxTimeline* timeline;
@@ -212,8 +279,27 @@ class ofxTLTrack
 
 	bool createdByTimeline;
 
+	int editDepth;
+	//from a mouse press until its release
+	bool mouseEditOpen;
+	bool unpublishedChanges;
+
+	vector<unsigned long long> snapIndex;
+	bool snapIndexDirty;
+
+#ifdef OFXTL_PROFILE
+	ofxTLTrackProfile profile;
+#endif
+
+	//use this instead of calling ofNotifyEvent directly from update()
+	void notify(std::function<void()> notification);
+	bool deferNotifications;
+	vector< std::function<void()> > deferredNotifications;
+
 	//will be our internal time when playing solo, otherwise timeline time
-	unsigned long long playbackStartTime;
+	//solo playback runs off the timeline's timer in integer micros, currentTime is in millis
+	long long playbackStartMicros;
+	long long currentTimeMicros;
 	unsigned long long currentTime;
 	bool isPlaying;
 	void checkLoop();
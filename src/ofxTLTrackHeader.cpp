@@ -35,6 +35,7 @@
 
 ofxTLTrackHeader::ofxTLTrackHeader(){
     track = nullptr;
+    nameField = nullptr;
 	draggingSize = false;
 	hoveringFooter = false;
 
@@ -50,6 +51,9 @@ ofxTLTrackHeader::~ofxTLTrackHeader(){
 void ofxTLTrackHeader::enable(){
 	if(!isEnabled()){
 		ofxTLTrack::enable();
+		if(nameField != nullptr || getTimeline()->getIsHeadless()){
+			return;
+		}
         nameField  = new ofTrueTypeFont();
         nameField->load(ofToDataPath("timeline/NewMediaFett.ttf"),10+(4*(getTimeline()->retinaScale-1)));
 	}
@@ -0,0 +1,105 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLUndoDelta.h"
+#include "ofxTLTrack.h"
+#include "ofxTLCompression.h"
+
+ofxTLUndoDelta::ofxTLUndoDelta(ofxTLTrack* track)
+:	track(track),
+	compressed(false),
+	compressionTried(false)
+{
+
+}
+
+ofxTLTrack* ofxTLUndoDelta::getTrack(){
+	return track;
+}
+
+size_t ofxTLUndoDelta::getMemoryUsage(){
+	return sizeof(*this) + before.capacity() + after.capacity();
+}
+
+void ofxTLUndoDelta::compress(){
+	if(compressionTried){
+		return;
+	}
+	compressionTried = true;
+	string smallBefore = ofxTLCompression::compress(before);
+	string smallAfter = ofxTLCompression::compress(after);
+	//tiny deltas can come out bigger, just leave those alone
+	if(smallBefore.size() + smallAfter.size() < before.size() + after.size()){
+		before.swap(smallBefore);
+		after.swap(smallAfter);
+		compressed = true;
+	}
+}
+
+bool ofxTLUndoDelta::isCompressed(){
+	return compressed;
+}
+
+bool ofxTLUndoDelta::wasCompressionTried(){
+	return compressionTried;
+}
+
+const string& ofxTLUndoDelta::expand(const string& state, string& scratch){
+	if(!compressed){
+		return state;
+	}
+	if(!ofxTLCompression::decompress(state, scratch)){
+		ofLogError("ofxTLUndoDelta::expand") << "Undo history for " << track->getName() << " is corrupt";
+		scratch.clear();
+	}
+	return scratch;
+}
+
+ofxTLXMLUndoDelta::ofxTLXMLUndoDelta(ofxTLTrack* track)
+:	ofxTLUndoDelta(track)
+{
+	before = track->getXMLRepresentation();
+}
+
+void ofxTLXMLUndoDelta::finish(){
+	after = track->getXMLRepresentation();
+}
+
+void ofxTLXMLUndoDelta::undo(){
+	string scratch;
+	track->loadFromXMLRepresentation(expand(before, scratch));
+}
+
+void ofxTLXMLUndoDelta::redo(){
+	string scratch;
+	track->loadFromXMLRepresentation(expand(after, scratch));
+}
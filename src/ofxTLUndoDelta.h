@@ -0,0 +1,82 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxTLTrack;
+
+//one track's part of an undoable action.
+//it's created right before the track might change and finish() is called once
+//the action is over, after that undo() and redo() move the track between the two states
+class ofxTLUndoDelta {
+  public:
+	ofxTLUndoDelta(ofxTLTrack* track);
+	virtual ~ofxTLUndoDelta(){};
+
+	virtual void finish() = 0;
+	virtual void undo() = 0;
+	virtual void redo() = 0;
+
+	ofxTLTrack* getTrack();
+
+	//bytes held on to by this delta
+	virtual size_t getMemoryUsage();
+	//older history gets squeezed down, it's expanded again on undo and redo
+	void compress();
+	bool isCompressed();
+	//true once compress() has run, even if the delta was too small to shrink
+	bool wasCompressionTried();
+
+  protected:
+	ofxTLTrack* track;
+
+	//subclasses keep the two states here so they can be measured and compressed
+	string before;
+	string after;
+	bool compressed;
+	bool compressionTried;
+	//returns state as it was stored, decompressing it into scratch if needed
+	const string& expand(const string& state, string& scratch);
+};
+
+//fallback for tracks that don't know how to describe their own changes,
+//stores the whole track as xml before and after
+class ofxTLXMLUndoDelta : public ofxTLUndoDelta {
+  public:
+	ofxTLXMLUndoDelta(ofxTLTrack* track);
+
+	virtual void finish();
+	virtual void undo();
+	virtual void redo();
+};
@@ -0,0 +1,196 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLWorkerPool.h"
+
+ofxTLWorkerPool::ofxTLWorkerPool()
+:	jobsRemaining(0),
+	generation(0),
+	running(false)
+{
+	//don't spin up threads until someone asks for them
+}
+
+ofxTLWorkerPool::~ofxTLWorkerPool(){
+	shutdown();
+}
+
+void ofxTLWorkerPool::setup(int numWorkers){
+	if(running){
+		shutdown();
+	}
+
+	if(numWorkers <= 0){
+		numWorkers = MAX(int(std::thread::hardware_concurrency()) - 1, 0);
+	}
+
+	for(int i = 0; i < numWorkers+1; i++){
+		queues.push_back(new WorkQueue());
+	}
+
+	running = true;
+	for(int i = 0; i < numWorkers; i++){
+		workers.push_back(std::thread(&ofxTLWorkerPool::workerLoop, this, i));
+	}
+}
+
+void ofxTLWorkerPool::shutdown(){
+	if(!running){
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(jobLock);
+		running = false;
+	}
+	jobStarted.notify_all();
+
+	for(int i = 0; i < workers.size(); i++){
+		workers[i].join();
+	}
+	workers.clear();
+
+	for(int i = 0; i < queues.size(); i++){
+		delete queues[i];
+	}
+	queues.clear();
+}
+
+bool ofxTLWorkerPool::isSetup(){
+	return running;
+}
+
+int ofxTLWorkerPool::getNumWorkers(){
+	return workers.size();
+}
+
+void ofxTLWorkerPool::parallelFor(int count, std::function<void(int)> job){
+	if(count <= 0){
+		return;
+	}
+
+	//nothing to share the work with
+	if(!running || workers.empty() || count == 1){
+		for(int i = 0; i < count; i++){
+			job(i);
+		}
+		return;
+	}
+
+	std::unique_lock<std::mutex> callerLock(callLock);
+
+	currentJob = job;
+	jobsRemaining = count;
+
+	//hand out contiguous runs so neighbouring tracks start on the same thread,
+	//stealing evens it out when some tracks are much heavier than others
+	int numQueues = queues.size();
+	int perQueue = count / numQueues;
+	int leftOver = count % numQueues;
+	int index = 0;
+	for(int q = 0; q < numQueues; q++){
+		int thisQueue = perQueue + (q < leftOver ? 1 : 0);
+		std::unique_lock<std::mutex> lock(queues[q]->lock);
+		for(int i = 0; i < thisQueue; i++){
+			queues[q]->indices.push_back(index++);
+		}
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(jobLock);
+		generation++;
+	}
+	jobStarted.notify_all();
+
+	//pitch in from the calling thread
+	while(runNext(numQueues-1)){
+	}
+
+	std::unique_lock<std::mutex> lock(jobLock);
+	while(jobsRemaining > 0){
+		jobFinished.wait(lock);
+	}
+	currentJob = nullptr;
+}
+
+bool ofxTLWorkerPool::runNext(int queueIndex){
+	int jobIndex = -1;
+
+	{
+		std::unique_lock<std::mutex> lock(queues[queueIndex]->lock);
+		if(!queues[queueIndex]->indices.empty()){
+			jobIndex = queues[queueIndex]->indices.front();
+			queues[queueIndex]->indices.pop_front();
+		}
+	}
+
+	//steal from the back of someone else's queue
+	for(int i = 1; jobIndex == -1 && i < queues.size(); i++){
+		WorkQueue* victim = queues[(queueIndex + i) % queues.size()];
+		std::unique_lock<std::mutex> lock(victim->lock);
+		if(!victim->indices.empty()){
+			jobIndex = victim->indices.back();
+			victim->indices.pop_back();
+		}
+	}
+
+	if(jobIndex == -1){
+		return false;
+	}
+
+	currentJob(jobIndex);
+
+	if(--jobsRemaining == 0){
+		std::unique_lock<std::mutex> lock(jobLock);
+		jobFinished.notify_all();
+	}
+	return true;
+}
+
+void ofxTLWorkerPool::workerLoop(int queueIndex){
+	unsigned long long lastGeneration = 0;
+	while(true){
+		{
+			std::unique_lock<std::mutex> lock(jobLock);
+			while(running && generation == lastGeneration){
+				jobStarted.wait(lock);
+			}
+			if(!running){
+				return;
+			}
+			lastGeneration = generation;
+		}
+
+		while(runNext(queueIndex)){
+		}
+	}
+}
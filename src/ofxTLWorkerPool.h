@@ -0,0 +1,84 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+
+//small work stealing pool used to update tracks side by side.
+//each worker owns a queue of job indices and pops from the front of it,
+//when it runs dry it steals from the back of the other queues.
+//the thread that calls parallelFor works too, so with 0 workers it just runs serially
+class ofxTLWorkerPool {
+  public:
+	ofxTLWorkerPool();
+	virtual ~ofxTLWorkerPool();
+
+	//passing 0 uses one less than the number of hardware threads
+	void setup(int numWorkers = 0);
+	void shutdown();
+	bool isSetup();
+	int getNumWorkers();
+
+	//calls job(i) for i in [0, count) and returns once all of them are done.
+	//only one parallelFor runs at a time per pool
+	void parallelFor(int count, std::function<void(int)> job);
+
+  protected:
+	typedef struct {
+		std::mutex lock;
+		std::deque<int> indices;
+	} WorkQueue;
+
+	void workerLoop(int queueIndex);
+	//runs one job from our own queue, or steals one. returns false if there was nothing left
+	bool runNext(int queueIndex);
+
+	vector<std::thread> workers;
+	//one queue per worker plus one for the calling thread at the end
+	vector<WorkQueue*> queues;
+
+	std::mutex callLock;
+	std::mutex jobLock;
+	std::condition_variable jobStarted;
+	std::condition_variable jobFinished;
+	std::function<void(int)> currentJob;
+	std::atomic<int> jobsRemaining;
+	unsigned long long generation;
+	bool running;
+};
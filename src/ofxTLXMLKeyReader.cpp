@@ -0,0 +1,287 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ofxTLXMLKeyReader.h"
+
+static bool tagNameIs(const char* name, size_t nameLength, const char* tag){
+	size_t tagLength = strlen(tag);
+	return nameLength == tagLength && memcmp(name, tag, tagLength) == 0;
+}
+
+ofxTLXMLKeyReader::ofxTLXMLKeyReader(const char* data, size_t length)
+:	position(data),
+	end(data + length),
+	keyStart(NULL),
+	keyEnd(NULL),
+	inKeyframes(false)
+{
+
+}
+
+bool ofxTLXMLKeyReader::nextTag(const char*& name, size_t& nameLength, TagKind& kind){
+	while(position < end){
+		position = (const char*)memchr(position, '<', end - position);
+		if(position == NULL){
+			position = end;
+			return false;
+		}
+
+		//comments, the declaration and the like don't matter to us
+		if(end - position >= 4 && memcmp(position, "<!--", 4) == 0){
+			const char* comment = position + 4;
+			while(comment + 3 <= end && memcmp(comment, "-->", 3) != 0){
+				comment++;
+			}
+			position = MIN(comment + 3, end);
+			continue;
+		}
+		if(end - position >= 2 && (position[1] == '?' || position[1] == '!')){
+			const char* close = (const char*)memchr(position, '>', end - position);
+			position = close == NULL ? end : close + 1;
+			continue;
+		}
+
+		bool closing = end - position >= 2 && position[1] == '/';
+		name = position + (closing ? 2 : 1);
+		const char* nameEnd = name;
+		while(nameEnd < end && !isspace(*nameEnd) && *nameEnd != '>' && *nameEnd != '/'){
+			nameEnd++;
+		}
+		nameLength = nameEnd - name;
+
+		const char* close = (const char*)memchr(nameEnd, '>', end - nameEnd);
+		if(close == NULL){
+			position = end;
+			return false;
+		}
+		kind = closing ? CLOSING_TAG : (close[-1] == '/' ? EMPTY_TAG : OPENING_TAG);
+		position = close + 1;
+		return true;
+	}
+	return false;
+}
+
+void ofxTLXMLKeyReader::skipElement(){
+	int depth = 1;
+	const char* name;
+	size_t nameLength;
+	TagKind kind;
+	while(depth > 0 && nextTag(name, nameLength, kind)){
+		if(kind == OPENING_TAG){
+			depth++;
+		}
+		else if(kind == CLOSING_TAG){
+			depth--;
+		}
+	}
+}
+
+bool ofxTLXMLKeyReader::nextKey(){
+	keyTags.clear();
+	const char* name;
+	size_t nameLength;
+	TagKind kind;
+	while(nextTag(name, nameLength, kind)){
+		if(!inKeyframes){
+			inKeyframes = kind == OPENING_TAG && tagNameIs(name, nameLength, "keyframes");
+			continue;
+		}
+		if(kind == CLOSING_TAG){
+			inKeyframes = !tagNameIs(name, nameLength, "keyframes");
+			continue;
+		}
+		if(!tagNameIs(name, nameLength, "key")){
+			if(kind == OPENING_TAG){
+				skipElement();
+			}
+			continue;
+		}
+
+		keyStart = name - 1;
+		if(kind == OPENING_TAG){
+			readKeyTags();
+		}
+		keyEnd = position;
+		return true;
+	}
+	return false;
+}
+
+void ofxTLXMLKeyReader::readKeyTags(){
+	const char* name;
+	size_t nameLength;
+	TagKind kind;
+	while(nextTag(name, nameLength, kind)){
+		if(kind == CLOSING_TAG){
+			return; //</key>
+		}
+		KeyTag tag;
+		tag.name = name;
+		tag.nameLength = nameLength;
+		tag.text = position;
+		tag.textLength = 0;
+		if(kind == OPENING_TAG){
+			const char* textEnd = (const char*)memchr(position, '<', end - position);
+			if(textEnd != NULL && end - textEnd >= 2 && textEnd[1] == '/'){
+				//the usual <tag>text</tag>
+				tag.textLength = textEnd - position;
+				position = textEnd;
+				nextTag(name, nameLength, kind);
+			}
+			else{
+				//anything nested has no text of its own
+				skipElement();
+			}
+		}
+		keyTags.push_back(tag);
+	}
+}
+
+ofxTLXMLKeyReader::KeyTag* ofxTLXMLKeyReader::findTag(const string& tag){
+	for(int i = 0; i < keyTags.size(); i++){
+		if(tagNameIs(keyTags[i].name, keyTags[i].nameLength, tag.c_str())){
+			return &keyTags[i];
+		}
+	}
+	return NULL;
+}
+
+bool ofxTLXMLKeyReader::tagExists(const string& tag){
+	return findTag(tag) != NULL;
+}
+
+bool ofxTLXMLKeyReader::getText(const string& tag, const char*& text, size_t& length){
+	KeyTag* keyTag = findTag(tag);
+	if(keyTag == NULL){
+		return false;
+	}
+	const char* textStart = keyTag->text;
+	const char* textEnd = keyTag->text + keyTag->textLength;
+	while(textStart < textEnd && isspace(*textStart)) textStart++;
+	while(textEnd > textStart && isspace(textEnd[-1])) textEnd--;
+	if(textStart == textEnd){
+		return false;
+	}
+	text = textStart;
+	length = textEnd - textStart;
+	return true;
+}
+
+int ofxTLXMLKeyReader::getValue(const string& tag, int defaultValue){
+	const char* text;
+	size_t length;
+	if(!getText(tag, text, length)){
+		return defaultValue;
+	}
+	//like ofToInt, anything that isn't a number reads as 0
+	const char* c = text;
+	const char* textEnd = text + length;
+	bool negative = c < textEnd && *c == '-';
+	if(c < textEnd && (*c == '-' || *c == '+')) c++;
+	int value = 0;
+	while(c < textEnd && *c >= '0' && *c <= '9'){
+		value = value * 10 + (*c - '0');
+		c++;
+	}
+	return negative ? -value : value;
+}
+
+double ofxTLXMLKeyReader::getValue(const string& tag, double defaultValue){
+	const char* text;
+	size_t length;
+	if(!getText(tag, text, length)){
+		return defaultValue;
+	}
+	//hand rolled so it doesn't depend on the locale's decimal point
+	const char* c = text;
+	const char* textEnd = text + length;
+	bool negative = c < textEnd && *c == '-';
+	if(c < textEnd && (*c == '-' || *c == '+')) c++;
+	double value = 0;
+	while(c < textEnd && *c >= '0' && *c <= '9'){
+		value = value * 10 + (*c - '0');
+		c++;
+	}
+	if(c < textEnd && *c == '.'){
+		c++;
+		double scale = 0.1;
+		while(c < textEnd && *c >= '0' && *c <= '9'){
+			value += (*c - '0') * scale;
+			scale *= 0.1;
+			c++;
+		}
+	}
+	if(c < textEnd && (*c == 'e' || *c == 'E')){
+		c++;
+		bool negativeExponent = c < textEnd && *c == '-';
+		if(c < textEnd && (*c == '-' || *c == '+')) c++;
+		int exponent = 0;
+		while(c < textEnd && *c >= '0' && *c <= '9'){
+			exponent = exponent * 10 + (*c - '0');
+			c++;
+		}
+		value *= pow(10.0, negativeExponent ? -exponent : exponent);
+	}
+	return negative ? -value : value;
+}
+
+string ofxTLXMLKeyReader::getValue(const string& tag, const string& defaultValue){
+	const char* text;
+	size_t length;
+	if(!getText(tag, text, length)){
+		return defaultValue;
+	}
+	string value;
+	value.reserve(length);
+	for(size_t i = 0; i < length; i++){
+		if(text[i] != '&'){
+			value += text[i];
+			continue;
+		}
+		const char* entity = text + i;
+		size_t remaining = length - i;
+		if(remaining >= 4 && memcmp(entity, "&lt;", 4) == 0){ value += '<'; i += 3; }
+		else if(remaining >= 4 && memcmp(entity, "&gt;", 4) == 0){ value += '>'; i += 3; }
+		else if(remaining >= 5 && memcmp(entity, "&amp;", 5) == 0){ value += '&'; i += 4; }
+		else if(remaining >= 6 && memcmp(entity, "&quot;", 6) == 0){ value += '"'; i += 5; }
+		else if(remaining >= 6 && memcmp(entity, "&apos;", 6) == 0){ value += '\''; i += 5; }
+		else{ value += '&'; }
+	}
+	return value;
+}
+
+string ofxTLXMLKeyReader::getKeyXML(){
+	if(keyStart == NULL){
+		return "";
+	}
+	return string(keyStart, keyEnd - keyStart);
+}
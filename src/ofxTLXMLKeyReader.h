@@ -0,0 +1,81 @@
+/**
+ * ofxTimeline
+ * openFrameworks graphical timeline addon
+ *
+ * Copyright (c) 2011-2012 James George
+ * Development Supported by YCAM InterLab http://interlab.ycam.jp/en/
+ * http://jamesgeorge.org + http://flightphase.com
+ * http://github.com/obviousjim + http://github.com/flightphase
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "ofMain.h"
+
+//reads the <keyframes><key>...</key></keyframes> xml that keyframe tracks save in a
+//single pass, without building a document. the current key's child tags are read
+//straight out of the text with the same defaults as ofxXmlSettings::getValue
+class ofxTLXMLKeyReader {
+  public:
+	ofxTLXMLKeyReader(const char* data, size_t length);
+
+	//moves on to the next <key> of any <keyframes> block, false once there are no more
+	bool nextKey();
+
+	bool tagExists(const string& tag);
+	int getValue(const string& tag, int defaultValue);
+	double getValue(const string& tag, double defaultValue);
+	string getValue(const string& tag, const string& defaultValue);
+	//the tag's text trimmed but not unescaped, without copying it. false if there's no text
+	bool getText(const string& tag, const char*& text, size_t& length);
+
+	//the whole current <key> element, for handing to ofxXmlSettings
+	string getKeyXML();
+
+  protected:
+	enum TagKind {
+		OPENING_TAG,
+		CLOSING_TAG,
+		EMPTY_TAG
+	};
+	bool nextTag(const char*& name, size_t& nameLength, TagKind& kind);
+	void skipElement();
+	void readKeyTags();
+
+	struct KeyTag {
+		const char* name;
+		size_t nameLength;
+		const char* text;
+		size_t textLength;
+	};
+	vector<KeyTag> keyTags;
+	KeyTag* findTag(const string& tag);
+
+	const char* position;
+	const char* end;
+	const char* keyStart;
+	const char* keyEnd;
+	bool inKeyframes;
+};
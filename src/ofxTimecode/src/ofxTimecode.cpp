@@ -10,31 +10,85 @@
 #include "ofxTimecode.h"
 
 ofxTimecode::ofxTimecode(){
-    fps = 30;
+    fpsNumerator = 30;
+    fpsDenominator = 1;
+    dropFrame = false;
 }
     
 void ofxTimecode::setFPS(float _fps){
-    if(fps < 1){
+    if(_fps < 1){
         ofLogError("ofxTimecode::setFPS invalid FPS set");
         return;
     }
-	fps = _fps;
+    //whole rates first so something like 1000 isn't taken for 1001*1000/1001
+    int ntsc = int(_fps * 1.001 + .5);
+    if(fabs(_fps - int(_fps + .5)) < .0001){
+        setFPS(int(_fps + .5), 1);
+    }
+    //23.976, 29.97, 47.952 and 59.94 are really n*1000/1001
+    else if((ntsc == 24 || ntsc == 30 || ntsc == 48 || ntsc == 60) && fabs(_fps - ntsc * 1000. / 1001.) < .005){
+        setFPS(ntsc * 1000, 1001);
+    }
+    else{
+        setFPS(int(_fps * 1000 + .5), 1000);
+    }
+}
+
+void ofxTimecode::setFPS(int numerator, int denominator){
+    if(denominator < 1 || numerator < denominator){
+        ofLogError("ofxTimecode::setFPS invalid FPS set");
+        return;
+    }
+    fpsNumerator = numerator;
+    fpsDenominator = denominator;
 }
 
 float ofxTimecode::getFPS(){
-    return fps;
+    return double(fpsNumerator) / fpsDenominator;
+}
+
+int ofxTimecode::getFPSNumerator(){
+    return fpsNumerator;
+}
+
+int ofxTimecode::getFPSDenominator(){
+    return fpsDenominator;
+}
+
+void ofxTimecode::setDropFrame(bool _dropFrame){
+    dropFrame = _dropFrame;
+}
+
+bool ofxTimecode::getDropFrame(){
+    return dropFrame;
+}
+
+int ofxTimecode::getNominalFPS(){
+    return (fpsNumerator + fpsDenominator / 2) / fpsDenominator;
+}
+
+//only 29.97 and 59.94 have a drop frame count, 2 or 4 frame numbers skipped each minute
+int ofxTimecode::getDroppedFrames(){
+    if(!dropFrame || fpsDenominator != 1001 || (fpsNumerator != 30000 && fpsNumerator != 60000)){
+        return 0;
+    }
+    return getNominalFPS() / 15;
 }
     
 //expects format HH:MM:SS:MLS
-unsigned long long ofxTimecode::millisForTimecode(string timecode){
+unsigned long long ofxTimecode::millisForTimecode(const string& timecode){
+    unsigned long long millis;
+    if(millisForTimecode(timecode.c_str(), timecode.size(), millis)){
+        return millis;
+    }
     int times[4];
     if(decodeString(timecode, times)){
-               //hours						
-    	return times[0] * 60 * 60 * 1000 + 
+               //hours, 64 bit so long timelines don't overflow
+    	return (long long)times[0] * 60 * 60 * 1000 +
                //minutes
-               times[1] * 60 * 1000 +
+               (long long)times[1] * 60 * 1000 +
                //seconds
-               times[2] * 1000 +
+               (long long)times[2] * 1000 +
                //millis
                times[3];
         
@@ -42,51 +96,219 @@ unsigned long long ofxTimecode::millisForTimecode(string timecode){
 	return -1;
 }
 
-string ofxTimecode::timecodeForMillis(unsigned long long millis, string millisDelimiter){
-    char buf[512];
-	sprintf(buf, "%02d:%02d:%02d%s%03d", int(millis / (60 * 60 * 1000)),  //hours
-            						    int((millis / (60 * 1000)) % 60), //minutes
-            						    int((millis / 1000) % 60), 		//seconds
-            							millisDelimiter.c_str(),
-                                        int(millis % 1000));
-//    sprintf(buf, "%ld", millis);
+bool ofxTimecode::millisForTimecode(const char* timecode, size_t length, unsigned long long& millis){
+    const char* c = timecode;
+    const char* end = timecode + length;
+    while(c < end && isspace(*c)) c++;
+    while(end > c && isspace(end[-1])) end--;
+    
+    unsigned long long times[4];
+    for(int i = 0; i < 4; i++){
+        if(c == end || *c < '0' || *c > '9'){
+            return false;
+        }
+        times[i] = 0;
+        while(c < end && *c >= '0' && *c <= '9'){
+            times[i] = times[i] * 10 + (*c - '0');
+            c++;
+        }
+        //same delimiters as decodeString
+        if(i < 3){
+            if(c == end || (*c != ':' && *c != ',' && *c != ';')){
+                return false;
+            }
+            c++;
+        }
+    }
+    if(c != end){
+        return false;
+    }
+    millis = times[0] * 60 * 60 * 1000 + times[1] * 60 * 1000 + times[2] * 1000 + times[3];
+    return true;
+}
+
+size_t ofxTimecode::millisForTimecodes(const char* timecodes, size_t length, unsigned long long* millis, size_t maxCount, char separator){
+    const char* c = timecodes;
+    const char* end = timecodes + length;
+    size_t count = 0;
+    while(c < end && count < maxCount){
+        const char* next = (const char*)memchr(c, separator, end - c);
+        if(next == NULL){
+            next = end;
+        }
+        //only odd timecodes take the allocating path
+        if(!millisForTimecode(c, next - c, millis[count])){
+            millis[count] = millisForTimecode(string(c, next));
+        }
+        count++;
+        c = next + 1;
+    }
+    return count;
+}
+
+//writes value with at least minDigits, zero padded like %02d
+static char* writeDigits(char* c, unsigned long long value, int minDigits){
+    char digits[20];
+    int numDigits = 0;
+    do {
+        digits[numDigits++] = '0' + value % 10;
+        value /= 10;
+    } while(value > 0);
+    while(numDigits < minDigits){
+        digits[numDigits++] = '0';
+    }
+    while(numDigits > 0){
+        *c++ = digits[--numDigits];
+    }
+    return c;
+}
+
+//copies what fits and keeps counting, like snprintf
+static void writeBounded(char* buffer, size_t bufferSize, size_t& length, const char* text, size_t textLength){
+    if(length + 1 < bufferSize){
+        memcpy(buffer + length, text, MIN(textLength, bufferSize - 1 - length));
+    }
+    length += textLength;
+}
+
+size_t ofxTimecode::timecodeForMillis(unsigned long long millis, char* buffer, size_t bufferSize, const char* millisDelimiter){
+    char hms[32];
+    char* c = writeDigits(hms, millis / (60 * 60 * 1000), 2); //hours
+    *c++ = ':';
+    c = writeDigits(c, (millis / (60 * 1000)) % 60, 2); //minutes
+    *c++ = ':';
+    c = writeDigits(c, (millis / 1000) % 60, 2); //seconds
+    char ms[4];
+    writeDigits(ms, millis % 1000, 3);
+    
+    size_t length = 0;
+    writeBounded(buffer, bufferSize, length, hms, c - hms);
+    writeBounded(buffer, bufferSize, length, millisDelimiter, strlen(millisDelimiter));
+    writeBounded(buffer, bufferSize, length, ms, 3);
+    if(bufferSize > 0){
+        buffer[MIN(length, bufferSize - 1)] = '\0';
+    }
+    return length;
+}
+
+string ofxTimecode::timecodeForMillis(unsigned long long millis, const string& millisDelimiter){
+    char buf[64];
+    size_t length = timecodeForMillis(millis, buf, sizeof(buf), millisDelimiter.c_str());
+    if(length < sizeof(buf)){
+        return string(buf, length);
+    }
+    //only for very long delimiters
+    vector<char> longBuf(length + 1);
+    timecodeForMillis(millis, &longBuf[0], longBuf.size(), millisDelimiter.c_str());
+    return string(&longBuf[0], length);
+}
 
-    return string(buf);
+void ofxTimecode::appendTimecodesForMillis(const unsigned long long* millis, size_t count, string& timecodes, char separator){
+    char buf[32];
+    timecodes.reserve(timecodes.size() + count * 13);
+    for(size_t i = 0; i < count; i++){
+        if(i > 0){
+            timecodes += separator;
+        }
+        timecodes.append(buf, timecodeForMillis(millis[i], buf, sizeof(buf)));
+    }
 }
 
 //expects format HH:MM:SS:FR
-float ofxTimecode::secondsForTimecode(string timecode){
+float ofxTimecode::secondsForTimecode(const string& timecode){
     return millisForTimecode(timecode) / 1000.;
 }
 
+//float seconds can land just short of a frame start, so anything within a thousandth of a frame counts as that frame
 int ofxTimecode::frameForSeconds(float timeInSeconds){
-    return timeInSeconds * fps;
+    return floor(double(timeInSeconds) * fpsNumerator / fpsDenominator + .001);
 }
 
 int ofxTimecode::frameForMillis(unsigned long long timeInMillis){
-    return timeInMillis * fps / 1000;
+    return timeInMillis * fpsNumerator / (1000ULL * fpsDenominator);
 }
 
 float ofxTimecode::secondsForFrame(int frame){
-	return frame / fps;
+	return double(frame) * fpsDenominator / fpsNumerator;
 }
 
+//frame start times round up so converting back lands on the same frame
 unsigned long long ofxTimecode::millisForFrame(int frame){
-	return frame * 1000 / fps;    
+    unsigned long long scaled = (unsigned long long)frame * fpsDenominator * 1000;
+	return (scaled + fpsNumerator - 1) / fpsNumerator;
+}
+
+int ofxTimecode::frameForMicros(unsigned long long timeInMicros){
+    return timeInMicros * fpsNumerator / (1000000ULL * fpsDenominator);
+}
+
+unsigned long long ofxTimecode::microsForFrame(int frame){
+    unsigned long long scaled = (unsigned long long)frame * fpsDenominator * 1000000;
+	return (scaled + fpsNumerator - 1) / fpsNumerator;
 }
 
-int ofxTimecode::frameForTimecode(string timecode){
+int ofxTimecode::frameForTimecode(const string& timecode){
     return frameForMillis(millisForTimecode(timecode));
 }
 
-string ofxTimecode::timecodeForSeconds(float seconds, string millisDelimiter){
+string ofxTimecode::timecodeForSeconds(float seconds, const string& millisDelimiter){
     return timecodeForMillis(seconds*1000, millisDelimiter);
 }
     
-string ofxTimecode::timecodeForFrame(int frame, string millisDelimiter){
+string ofxTimecode::timecodeForFrame(int frame, const string& millisDelimiter){
     return timecodeForMillis(millisForFrame(frame), millisDelimiter);
 }
 
+string ofxTimecode::smpteForFrame(int frame){
+    int nominal = getNominalFPS();
+    int dropped = getDroppedFrames();
+    unsigned long long label = MAX(frame, 0);
+    if(dropped > 0){
+        //every minute skips the first labels, except each tenth minute
+        unsigned long long framesPerMinute = nominal * 60 - dropped;
+        unsigned long long framesPer10Minutes = framesPerMinute * 10 + dropped;
+        unsigned long long tens = label / framesPer10Minutes;
+        unsigned long long remainder = label % framesPer10Minutes;
+        label += dropped * 9 * tens;
+        if(remainder > (unsigned long long)dropped){
+            label += dropped * ((remainder - dropped) / framesPerMinute);
+        }
+    }
+    char buf[32];
+    char* c = buf;
+    unsigned long long fields[4] = {
+        label / (nominal * 60 * 60ULL),
+        (label / (nominal * 60)) % 60,
+        (label / nominal) % 60,
+        label % nominal
+    };
+    for(int i = 0; i < 4; i++){
+        if(i > 0){
+            *c++ = (i == 3 && dropped > 0) ? ';' : ':';
+        }
+        if(fields[i] < 10){
+            *c++ = '0';
+        }
+        c += sprintf(c, "%llu", fields[i]);
+    }
+    return string(buf, c - buf);
+}
+
+string ofxTimecode::smpteForMillis(unsigned long long millis){
+    return smpteForFrame(frameForMillis(millis));
+}
+
+int ofxTimecode::frameForSmpte(const string& smpte){
+    //same layout as a millis timecode, the last field is frames
+    int times[4];
+    if(!decodeString(smpte, times)){
+        return -1;
+    }
+    long long totalMinutes = times[0] * 60LL + times[1];
+    long long frame = (totalMinutes * 60 + times[2]) * getNominalFPS() + times[3];
+    return frame - getDroppedFrames() * (totalMinutes - totalMinutes / 10);
+}
+
 bool ofxTimecode::decodeString(string time, int* times){
 	ofStringReplace(time, ",", ":");
     ofStringReplace(time, ";", ":");
@@ -16,13 +16,24 @@ class ofxTimecode {
     ofxTimecode();
     
     void setFPS(float fps); //default is 30;
+    //exact rate, e.g. 30000/1001 for 29.97. setFPS(float) picks these for the NTSC rates
+    void setFPS(int numerator, int denominator);
     float getFPS();
+    int getFPSNumerator();
+    int getFPSDenominator();
+    
+    //SMPTE drop frame counting for 29.97 and 59.94, only changes the HH:MM:SS;FF timecodes
+    void setDropFrame(bool dropFrame);
+    bool getDropFrame();
     
     //these functions expect format HH:MM:SS:MLS
     //and negative value if improperly formatted
-	static unsigned long long millisForTimecode(string timecode);
-    static float secondsForTimecode(string timecode);
-    int frameForTimecode(string timecode);
+	static unsigned long long millisForTimecode(const string& timecode);
+    //integer only version for parsing lots of timecodes, doesn't allocate.
+    //returns false for anything it doesn't understand, the string version may still read it
+    static bool millisForTimecode(const char* timecode, size_t length, unsigned long long& millis);
+    static float secondsForTimecode(const string& timecode);
+    int frameForTimecode(const string& timecode);
     
     int frameForSeconds(float timeInSeconds);
     int frameForMillis(unsigned long long timeInMillis);
@@ -30,12 +41,34 @@ class ofxTimecode {
     float secondsForFrame(int frame);
     unsigned long long millisForFrame(int frame);
     
+    //integer clock used by the timeline for playback
+    int frameForMicros(unsigned long long timeInMicros);
+    unsigned long long microsForFrame(int frame);
+    
     //returns format HH:MM:SS:FR
-    static string timecodeForMillis(unsigned long long millis, string millisDelimiter = ":");
-    static string timecodeForSeconds(float seconds, string millisDelimiter = ":");
-    string timecodeForFrame(int frame, string millisDelimiter = ":");
+    static string timecodeForMillis(unsigned long long millis, const string& millisDelimiter = ":");
+    static string timecodeForSeconds(float seconds, const string& millisDelimiter = ":");
+    string timecodeForFrame(int frame, const string& millisDelimiter = ":");
+    
+    //SMPTE frame timecodes, HH:MM:SS:FF or HH:MM:SS;FF when drop frame is on
+    string smpteForFrame(int frame);
+    string smpteForMillis(unsigned long long millis);
+    int frameForSmpte(const string& smpte);
+    //writes into the caller's buffer without allocating. works like snprintf, the result is always
+    //terminated and the full length is returned even if it didn't fit. 32 chars is always enough for ":"
+    static size_t timecodeForMillis(unsigned long long millis, char* buffer, size_t bufferSize, const char* millisDelimiter = ":");
+    
+    //batch versions for lots of timestamps, the timecodes are joined by separator.
+    //appending reuses the capacity of timecodes, decoding returns how many millis were written
+    static void appendTimecodesForMillis(const unsigned long long* millis, size_t count, string& timecodes, char separator = '\n');
+    static size_t millisForTimecodes(const char* timecodes, size_t length, unsigned long long* millis, size_t maxCount, char separator = '\n');
     
   protected:
-    float fps;
+    //frame conversions are done in 64 bit integers so long shows don't drift
+    int fpsNumerator;
+    int fpsDenominator;
+    bool dropFrame;
+    int getNominalFPS();
+    int getDroppedFrames();
     static bool decodeString(string time, int* times);
 };
@@ -48,6 +48,9 @@ ofxTimeline::ofxTimeline()
 :	width(1024),
 	offset(ofVec2f(0,0)),
 	autosave(true),
+	useJournal(false),
+	loadingTracks(false),
+	journalCompactSize(1024*1024),
 	isFrameBased(false),
 	timelineHasFocus(false),
 	showTicker(true),
@@ -56,6 +59,7 @@ ofxTimeline::ofxTimeline()
 	durationInSeconds(100.0f/30.0f),
 	isShowing(true),
 	isSetup(false),
+	isHeadless(false),
 	usingEvents(false),
 	isPlaying(false),
 	isEnabled(false),
@@ -76,12 +80,23 @@ ofxTimeline::ofxTimeline()
     timeControl(nullptr),
 	loopType(OF_LOOP_NONE),
 	lockWidthToWindow(true),
-	currentTime(0.0),
+	currentTimeMicros(0),
+	playbackStartMicros(0),
+	playbackStartFrame(0),
 	undoPointer(0),
 	undoEnabled(true),
+	undoMemoryBudget(0),
+	compressUndo(false),
+	uncompressedUndoActions(10),
 	isOnThread(false),
+	parallelUpdate(false),
+	scheduler(nullptr),
+	threadSampleRate(0),
+	threadWakeRequested(false),
 	unsavedChanges(false),
 	curvesUseBinary(false),
+	useMappedLoad(false),
+	lazyPageLoading(false),
 	headersAreEditable(false),
 	minimalHeaders(false),
     defaultPalettePath(ofToDataPath("timeline/defaultColorPalette.png")),
@@ -94,6 +109,9 @@ ofxTimeline::ofxTimeline()
 }
 
 ofxTimeline::~ofxTimeline(){
+	if(scheduler != nullptr){
+		scheduler->removeTimeline(this);
+	}
 	if(isSetup){
 
 		disable();
@@ -124,7 +142,9 @@ void ofxTimeline::setup(){
 
 	isSetup = true;
 
-	width = ofGetWidth();
+	if(!isHeadless){
+		width = ofGetWidth();
+	}
     if(tabs != nullptr){
         delete tabs;
     }
@@ -174,6 +194,22 @@ void ofxTimeline::setup(){
 
 }
 
+void ofxTimeline::setHeadless(bool headless){
+	if(isSetup){
+		ofLogError("ofxTimeline::setHeadless") << "Call setHeadless() before setup()";
+		return;
+	}
+	isHeadless = headless;
+	//there is no window to follow, the width only maps screen space to time
+	if(isHeadless){
+		lockWidthToWindow = false;
+	}
+}
+
+bool ofxTimeline::getIsHeadless(){
+	return isHeadless;
+}
+
 void ofxTimeline::moveToThread(){
 	if(!isOnThread){
 		stop();
@@ -189,9 +225,161 @@ void ofxTimeline::removeFromThread(){
 		stop();
 		isOnThread = false;
 		ofAddListener(ofEvents().update, this, &ofxTimeline::update);
-		ofRemoveListener(ofEvents().exit, this, &ofxTimeline::exit);
-		waitForThread(true);
+		if(scheduler != nullptr){
+			scheduler->removeTimeline(this);
+			scheduler = nullptr;
+		}
+		else{
+			ofRemoveListener(ofEvents().exit, this, &ofxTimeline::exit);
+			stopThread();
+			wakeThread();
+			waitForThread(false);
+		}
+	}
+}
+
+void ofxTimeline::moveToScheduler(ofxTLScheduler* newScheduler){
+	if(newScheduler == nullptr){
+		ofLogError("ofxTimeline::moveToScheduler -- scheduler is null");
+		return;
+	}
+	if(scheduler == newScheduler){
+		return;
+	}
+	removeFromThread();
+
+	//switching clocks, so playback has to start over
+	stop();
+	isOnThread = true;
+	scheduler = newScheduler;
+	ofRemoveListener(ofEvents().update, this, &ofxTimeline::update);
+	scheduler->addTimeline(this);
+}
+
+ofxTLScheduler* ofxTimeline::getScheduler(){
+	return scheduler;
+}
+
+void ofxTimeline::setThreadSampleRate(float samplesPerSecond){
+	threadSampleRate = MAX(samplesPerSecond, 0);
+	wakeThread();
+}
+
+float ofxTimeline::getThreadSampleRate(){
+	return threadSampleRate;
+}
+
+void ofxTimeline::wakeThread(){
+	if(scheduler != nullptr){
+		scheduler->wake();
+		return;
+	}
+	std::unique_lock<std::mutex> lock(threadWakeLock);
+	threadWakeRequested = true;
+	threadWakeCondition.notify_all();
+}
+
+long long ofxTimeline::getNextWakeMicros(){
+	long long now = getClockMicros();
+
+	long long wake = -1;
+	if(threadSampleRate > 0){
+		wake = now + 1000000.0/threadSampleRate;
+	}
+
+	//a time control track moves the playhead from its own update, so it's checked once a frame
+	if(timeControl != NULL && getIsPlaying()){
+		long long nextFrame = now + timecode.microsForFrame(1);
+		wake = wake < 0 ? nextFrame : MIN(wake, nextFrame);
+	}
+
+	//solo tracks run on their own clock
+	for(int i = 0; i < pages.size(); i++){
+		vector<ofxTLTrack*>& tracks = pages[i]->getTracks();
+		for(int t = 0; t < tracks.size(); t++){
+			long long trackWake = tracks[t]->getSoloWakeMicros();
+			if(trackWake >= 0){
+				wake = wake < 0 ? trackWake : MIN(wake, trackWake);
+			}
+		}
+	}
+
+	//frame based time only moves on with the app's frames, update() wakes the thread for each one
+	if(isPlaying && timeControl == NULL && !isFrameBased){
+		//the out point always gets a wake up so looping and stopping stay on time
+		long long nextMicros = getOutTimeInMicros();
+		for(int i = 0; i < pages.size(); i++){
+			unsigned long long nextMillis = pages[i]->getNextEventTime(getCurrentTimeMillis());
+			if(nextMillis != ULLONG_MAX){
+				nextMicros = MIN(nextMicros, (long long)nextMillis*1000);
+			}
+		}
+		long long nextEvent = playbackStartMicros + nextMicros;
+		wake = wake < 0 ? nextEvent : MIN(wake, nextEvent);
+	}
+
+	return wake;
+}
+
+void ofxTimeline::setParallelUpdate(bool parallel, int numThreads){
+	parallelUpdate = parallel;
+	if(parallelUpdate){
+		workerPool.setup(numThreads);
+	}
+	else{
+		workerPool.shutdown();
+	}
+}
+
+bool ofxTimeline::getParallelUpdate(){
+	return parallelUpdate;
+}
+
+vector<ofxTLTrackStats> ofxTimeline::getStats(){
+	vector<ofxTLTrackStats> stats;
+#ifdef OFXTL_PROFILE
+	for(int i = 0; i < pages.size(); i++){
+		vector<ofxTLTrack*>& tracks = pages[i]->getTracks();
+		for(int t = 0; t < tracks.size(); t++){
+			ofxTLTrackStats trackStats;
+			trackStats.name = tracks[t]->getName();
+			trackStats.type = tracks[t]->getTrackType();
+			tracks[t]->getProfile().get(trackStats.sections);
+			stats.push_back(trackStats);
+		}
+	}
+#endif
+	return stats;
+}
+
+void ofxTimeline::resetStats(){
+#ifdef OFXTL_PROFILE
+	for(int i = 0; i < pages.size(); i++){
+		vector<ofxTLTrack*>& tracks = pages[i]->getTracks();
+		for(int t = 0; t < tracks.size(); t++){
+			tracks[t]->getProfile().reset();
+		}
 	}
+#endif
+}
+
+bool ofxTimeline::saveStats(string filePath){
+	if(!ofxTLProfiler::isEnabled()){
+		ofLogError("ofxTimeline::saveStats") << "Build with OFXTL_PROFILE defined to collect stats";
+		return false;
+	}
+	vector<ofxTLTrackStats> stats = getStats();
+	bool csv = ofToLower(ofFilePath::getFileExt(filePath)) == "csv";
+	string contents = csv ? ofxTLProfiler::getStatsCSV(stats) : ofxTLProfiler::getStatsJSON(stats);
+	if(!ofxTLSaveJob::writeFileAtomically(ofToDataPath(filePath), contents)){
+		ofLogError("ofxTimeline::saveStats") << "Couldn't write " << filePath;
+		return false;
+	}
+	return true;
+}
+
+ofxTLWorkerPool& ofxTimeline::getWorkerPool(){
+	return workerPool;
 }
 
 void ofxTimeline::setName(string newName){
@@ -233,6 +421,8 @@ string ofxTimeline::getName(){
 }
 
 void ofxTimeline::setWorkingFolder(string folderPath){
+	//the journal belongs to the old folder
+	closeJournal();
 	workingFolder = ofFilePath::addTrailingSlash(folderPath);
 
 	if(isSetup){
@@ -245,13 +435,71 @@ string ofxTimeline::getWorkingFolder(){
 }
 
 void ofxTimeline::loadTracksFromFolder(string folderPath){
+	//still read in parallel, just without letting go
+	loadTracksFromFolderAsync(folderPath);
+	waitForLoad();
+}
+
+void ofxTimeline::loadTracksFromFolderAsync(string folderPath, int numThreads){
+	waitForLoad();
+	//a late autosave would write the old keys over what's about to be loaded
+	autosaver.flush();
+	closeJournal();
+	vector<ofxTLLoadJob*> jobs;
     for(int i = 0; i < pages.size(); i++){
-        pages[i]->loadTracksFromFolder(folderPath);
+        pages[i]->beginLoadingTracksFromFolder(folderPath, jobs);
     }
 
 //	cout << "*****TL " << name << " Loading tracks from " << folderPath << endl;
 
 	setWorkingFolder(folderPath);
+	loadingTracks = true;
+	loader.start(jobs, numThreads);
+	updateLoad();
+}
+
+void ofxTimeline::updateLoad(){
+	if(!loadingTracks){
+		return;
+	}
+	int finished = loader.update();
+
+	ofxTLLoadEventArgs args;
+	args.sender = this;
+	args.tracksLoaded = loader.getNumFinished();
+	args.totalTracks = loader.getNumJobs();
+	args.progress = getLoadProgress();
+	if(finished > 0){
+		ofNotifyEvent(events().loadProgressed, args);
+	}
+	if(!loader.isLoading()){
+		loadingTracks = false;
+		if(useJournal){
+			recoverJournal();
+		}
+		if(lazyPageLoading && currentPage != NULL){
+			currentPage->loadEditorData();
+		}
+		ofNotifyEvent(events().loadFinished, args);
+	}
+}
+
+bool ofxTimeline::isLoading(){
+	return loadingTracks;
+}
+
+float ofxTimeline::getLoadProgress(){
+	if(!loadingTracks || loader.getNumJobs() == 0){
+		return 1.0;
+	}
+	return float(loader.getNumFinished()) / loader.getNumJobs();
+}
+
+void ofxTimeline::waitForLoad(){
+	while(loadingTracks){
+		loader.waitForRead();
+		updateLoad();
+	}
 }
 
 void ofxTimeline::saveTracksToFolder(string folderPath){
@@ -326,6 +574,9 @@ void ofxTimeline::setShowZoomer(bool shouldShowZoomer){
 }
 
 void ofxTimeline::setupFont(){
+	if(isHeadless){
+		return;
+	}
     font.load(fontPath,fontSize+(4*(retinaScale-1)));
 }
 
@@ -336,7 +587,7 @@ void ofxTimeline::setupFont(string newFontPath, int newFontSize){
 }
 
 OFX_TIMELINE_FONT_RENDERER & ofxTimeline::getFont(){
-	if(!font.isLoaded()){
+	if(!font.isLoaded() && !isHeadless){
 		setupFont();
 	}
 	return font;
@@ -366,25 +617,111 @@ void ofxTimeline::enableUndo(bool enabled){
 void ofxTimeline::undo(){
     if(undoPointer > 0){
     	undoPointer--;
-        restoreToState(undoStack[undoPointer]);
+        vector<ofxTLUndoDelta*>& action = undoStack[undoPointer];
+        for(int i = action.size()-1; i >= 0; i--){
+            action[i]->getTrack()->beginEdit();
+            action[i]->undo();
+            action[i]->getTrack()->endEdit();
+        }
 		unsavedChanges = true;
     }
 }
 
 void ofxTimeline::redo(){
-    if(undoPointer < undoStack.size()-1){
+    if(undoPointer < undoStack.size()){
+        vector<ofxTLUndoDelta*>& action = undoStack[undoPointer];
+        for(int i = 0; i < action.size(); i++){
+            action[i]->getTrack()->beginEdit();
+            action[i]->redo();
+            action[i]->getTrack()->endEdit();
+        }
         undoPointer++;
-		restoreToState(undoStack[undoPointer]);
 		unsavedChanges = true;
     }
 }
 
-void ofxTimeline::restoreToState(vector<UndoItem>& state){
-    for(int i = 0; i < state.size(); i++){
-//		cout << "restoring state for track " << state[i].track->getDisplayName() << endl;
-//		cout << state[i].stateBuffer << endl;
-        state[i].track->loadFromXMLRepresentation(state[i].stateBuffer);
+void ofxTimeline::setUndoMemoryBudget(size_t bytes){
+    undoMemoryBudget = bytes;
+    trimUndoHistory();
+}
+
+size_t ofxTimeline::getUndoMemoryBudget(){
+    return undoMemoryBudget;
+}
+
+void ofxTimeline::setUndoCompression(bool compress, int uncompressedActions){
+    compressUndo = compress;
+    uncompressedUndoActions = MAX(uncompressedActions, 0);
+    trimUndoHistory();
+}
+
+bool ofxTimeline::getUndoCompression(){
+    return compressUndo;
+}
+
+size_t ofxTimeline::getUndoMemoryUsage(){
+    size_t bytes = 0;
+    for(int i = 0; i < undoStack.size(); i++){
+        bytes += getUndoActionMemoryUsage(undoStack[i]);
+    }
+    //an action that's still in progress counts too
+    bytes += getUndoActionMemoryUsage(stateBuffers);
+    return bytes;
+}
+
+int ofxTimeline::getUndoStackSize(){
+    return undoStack.size();
+}
+
+size_t ofxTimeline::getUndoActionMemoryUsage(vector<ofxTLUndoDelta*>& action){
+    size_t bytes = 0;
+    for(int i = 0; i < action.size(); i++){
+        bytes += action[i]->getMemoryUsage();
+    }
+    return bytes;
+}
+
+void ofxTimeline::trimUndoHistory(){
+    if(compressUndo){
+        //newest to oldest, everything past the first action that went through this already has
+        for(int i = int(undoStack.size()) - 1 - uncompressedUndoActions; i >= 0; i--){
+            if(undoStack[i].size() > 0 && undoStack[i][0]->wasCompressionTried()){
+                break;
+            }
+            for(int d = 0; d < undoStack[i].size(); d++){
+                undoStack[i][d]->compress();
+            }
+        }
+    }
+
+    if(undoMemoryBudget == 0){
+        return;
+    }
+
+    //drop the oldest actions until we fit, but always keep the last one so it can be undone
+    size_t bytes = getUndoMemoryUsage();
+    while(bytes > undoMemoryBudget && undoStack.size() > 1 && undoPointer > 0){
+        bytes -= getUndoActionMemoryUsage(undoStack.front());
+        for(int d = 0; d < undoStack.front().size(); d++){
+            delete undoStack.front()[d];
+        }
+        undoStack.pop_front();
+        undoPointer--;
+    }
+}
+
+void ofxTimeline::clearUndoHistory(){
+    for(int i = 0; i < undoStack.size(); i++){
+        for(int d = 0; d < undoStack[i].size(); d++){
+            delete undoStack[i][d];
+        }
+    }
+    undoStack.clear();
+    undoPointer = 0;
+    for(int i = 0; i < stateBuffers.size(); i++){
+        delete stateBuffers[i];
     }
+    stateBuffers.clear();
 }
 
 //called on mouse down and key down
@@ -396,19 +733,18 @@ void ofxTimeline::collectStateBuffers(){
     if(!undoEnabled) return;
 
     vector<ofxTLTrack*> tracks = currentPage->getTracks();
+    //anything left over is from an action that never finished
+    for(int i = 0; i < stateBuffers.size(); i++){
+        delete stateBuffers[i];
+    }
     stateBuffers.clear();
     modifiedTracks.clear();
     for(int i = 0; i < tracks.size(); i++){
         ofxTLTrack* track = tracks[i];
         if(track->getSelectedItemCount() > 0 || track->isHovering() || track->hasFocus()){
-
-            UndoItem ui;
-            ui.track = track;
-            ui.stateBuffer = track->getXMLRepresentation();
-            stateBuffers.push_back(ui);
+            OFXTL_PROFILE_SCOPE(track, OFXTL_PROFILE_UNDO);
+            stateBuffers.push_back(track->beginUndoDelta());
 //			cout << "collecting state for " << track->getDisplayName() << endl;
-//			cout << ui.stateBuffer << endl;
-
         }
     }
 }
@@ -420,36 +756,31 @@ void ofxTimeline::pushUndoStack(){
 
     if(!undoEnabled) return;
 
-    vector<UndoItem> undoCollection;
-	std::set<ofxTLTrack*>::iterator trackit;
-//    for(int i = 0; i < modifiedTracks.size(); i++){
-	for(trackit = modifiedTracks.begin(); trackit != modifiedTracks.end(); trackit++){
-        for(int buf = 0; buf < stateBuffers.size(); buf++){
-            //this m
-            if(*trackit == stateBuffers[buf].track){
-//				cout << "modified state buffer for " << modifiedTracks[i]->getDisplayName() << endl;
-                undoCollection.push_back(stateBuffers[buf]);
-            }
+    vector<ofxTLUndoDelta*> undoCollection;
+    for(int buf = 0; buf < stateBuffers.size(); buf++){
+        if(modifiedTracks.find(stateBuffers[buf]->getTrack()) != modifiedTracks.end()){
+//			cout << "modified state buffer for " << stateBuffers[buf]->getTrack()->getDisplayName() << endl;
+            OFXTL_PROFILE_SCOPE(stateBuffers[buf]->getTrack(), OFXTL_PROFILE_UNDO);
+            stateBuffers[buf]->finish();
+            undoCollection.push_back(stateBuffers[buf]);
+        }
+        else{
+            delete stateBuffers[buf];
         }
     }
+    stateBuffers.clear();
 
     if(undoCollection.size() > 0){
         //remove any history that we've undone
         while(undoPointer < undoStack.size()){
+            for(int d = 0; d < undoStack.back().size(); d++){
+                delete undoStack.back()[d];
+            }
             undoStack.pop_back();
         }
         undoStack.push_back(undoCollection);
         undoPointer = undoStack.size();
-
-        //store the most recent state at the top of the queue
-        vector<UndoItem> currentState;
-		for(trackit = modifiedTracks.begin(); trackit != modifiedTracks.end(); trackit++){
-            UndoItem ui;
-            ui.track = *trackit;//modifiedTracks[i];
-            ui.stateBuffer = (*trackit)->getXMLRepresentation();
-            currentState.push_back(ui);
-        }
-        undoStack.push_back(currentState);
+        trimUndoHistory();
     }
 
 }
@@ -467,7 +798,7 @@ ofxTLPlaybackEventArgs ofxTimeline::createPlaybackEvent(){
     args.sender = this;
 	args.durationInFrames = timecode.frameForSeconds(durationInSeconds);
 	args.durationInSeconds = durationInSeconds;
-	args.currentTime = currentTime;
+	args.currentTime = getCurrentTime();
 	args.currentFrame = getCurrentFrame();
 	args.currentPercent = getPercentComplete();
 	return args;
@@ -477,6 +808,8 @@ ofxTLPlaybackEventArgs ofxTimeline::createPlaybackEvent(){
 //can call repeatedly without incurring saves
 void ofxTimeline::flagUserChangedValue(){
 	userChangedValue = true;
+	//edits can move what's scheduled next
+	wakeThread();
 }
 
 //this returns and clears the flag, generally call once per frame
@@ -489,6 +822,7 @@ bool ofxTimeline::getUserChangedValue(){
 void ofxTimeline::flagTrackModified(ofxTLTrack* track){
 //	cout << "modified track " << track->getDisplayName() << endl;
 	flagUserChangedValue();
+	track->markChanged();
 
     if(undoEnabled){
         modifiedTracks.insert(track);
@@ -496,21 +830,186 @@ void ofxTimeline::flagTrackModified(ofxTLTrack* track){
 
     unsavedChanges = true;
     if(autosave){
-        track->save();
+		//its file is still being read, which will replace this anyway
+		if(loader.isLoading(track)){
+			return;
+		}
+		if(useJournal && journalChanges(track)){
+			return;
+		}
+		ofxTLSaveJob* job = track->beginBackgroundSave();
+		if(job != NULL){
+			autosaver.queue(job);
+		}
+		else{
+			autosaver.cancel(track);
+			OFXTL_PROFILE_SCOPE(track, OFXTL_PROFILE_SAVE);
+			track->save();
+		}
+		//later changes are logged against what was just saved
+		if(journal.isOpen()){
+			track->startJournal();
+		}
     }
 }
 
+bool ofxTimeline::journalChanges(ofxTLTrack* track){
+	if(!journal.isOpen()){
+		//saves everything, this change included
+		openJournal();
+		return journal.isOpen();
+	}
+
+	string removed;
+	string written;
+	if(!track->storeJournalChanges(removed, written)){
+		return false;
+	}
+	if(removed.empty() && written.empty()){
+		return true;
+	}
+	if(!journal.append(track->getName(), removed, written)){
+		return false;
+	}
+	journaledTracks.insert(track);
+	if(journal.getSize() > journalCompactSize){
+		compactJournal();
+	}
+	return true;
+}
+
+void ofxTimeline::openJournal(){
+	recoverJournal();
+	if(journal.open(getJournalPath())){
+		save();
+	}
+}
+
+void ofxTimeline::restartJournal(){
+	if(!journal.isOpen()){
+		return;
+	}
+	journaledTracks.clear();
+	for(int i = 0; i < pages.size(); i++){
+		vector<ofxTLTrack*>& tracks = pages[i]->getTracks();
+		for(int t = 0; t < tracks.size(); t++){
+			tracks[t]->startJournal();
+		}
+	}
+	journal.clear();
+}
+
+void ofxTimeline::compactJournal(){
+	//the last compaction has to be finished before the log can be moved aside again
+	autosaver.flush();
+	if(!journal.rotate()){
+		return;
+	}
+	ofxTLJournalCompaction* compaction = new ofxTLJournalCompaction(journal.getCompactingPath());
+	for(std::set<ofxTLTrack*>::iterator it = journaledTracks.begin(); it != journaledTracks.end(); it++){
+		ofxTLSaveJob* job = (*it)->beginBackgroundSave();
+		if(job == NULL){
+			(*it)->save();
+		}
+		compaction->addTrack((*it)->getName(), job);
+		(*it)->startJournal();
+	}
+	journaledTracks.clear();
+	autosaver.queue(compaction);
+}
+
+void ofxTimeline::closeJournal(){
+	if(!journal.isOpen()){
+		return;
+	}
+	autosaver.flush();
+	for(std::set<ofxTLTrack*>::iterator it = journaledTracks.begin(); it != journaledTracks.end(); it++){
+		(*it)->save();
+	}
+	journaledTracks.clear();
+	journal.close();
+	ofxTLJournal::remove(journal.getPath());
+}
+
+bool ofxTimeline::recoverJournal(){
+	//once it's open the log is ours, not something left from before
+	if(journal.isOpen()){
+		return false;
+	}
+	string path = getJournalPath();
+	vector<ofxTLJournal::Entry> edits;
+	ofxTLJournal::readForRecovery(path, edits);
+	if(edits.empty()){
+		ofxTLJournal::remove(path);
+		return false;
+	}
+
+	std::set<ofxTLTrack*> replayed;
+	bool missingTracks = false;
+	for(int i = 0; i < edits.size(); i++){
+		if(!hasTrack(edits[i].trackName)){
+			missingTracks = true;
+			continue;
+		}
+		ofxTLTrack* track = getTrack(edits[i].trackName);
+		if(track->replayJournalChanges(edits[i].removed, edits[i].written)){
+			replayed.insert(track);
+		}
+		else{
+			ofLogError("ofxTimeline::recoverJournal") << "Couldn't replay journaled changes to " << edits[i].trackName;
+		}
+	}
+	for(std::set<ofxTLTrack*>::iterator it = replayed.begin(); it != replayed.end(); it++){
+		(*it)->save();
+	}
+	//edits for tracks that haven't been added yet stay until the journal is opened
+	if(missingTracks){
+		ofLogError("ofxTimeline::recoverJournal") << "The journal has changes to tracks that aren't in " << name << ", they'll be lost when it's next written";
+	}
+	else{
+		ofxTLJournal::remove(path);
+	}
+	return replayed.size() > 0;
+}
+
+void ofxTimeline::setUseBinarySave(bool useBinary){
+	curvesUseBinary = useBinary;
+}
+
+bool ofxTimeline::getUseBinarySave(){
+	return curvesUseBinary;
+}
+
+void ofxTimeline::setUseMappedLoad(bool useMapped){
+	useMappedLoad = useMapped;
+}
+
+bool ofxTimeline::getUseMappedLoad(){
+	return useMappedLoad;
+}
+
+void ofxTimeline::setLazyPageLoading(bool lazy){
+	lazyPageLoading = lazy;
+}
+
+bool ofxTimeline::getLazyPageLoading(){
+	return lazyPageLoading;
+}
+
 bool ofxTimeline::hasUnsavedChanges(){
 	return unsavedChanges;
 }
 
 void ofxTimeline::save(){
+	//so nothing older lands on top of what's written here
+	autosaver.flush();
 	for(int i = 0; i < pages.size(); i++){
         pages[i]->save();
     }
 	zoomer->save();
 	inoutTrack->save();
 	unsavedChanges = false;
+	restartJournal();
 }
 
 void ofxTimeline::play(){
@@ -530,11 +1029,12 @@ void ofxTimeline::play(){
         }
 
 		isPlaying = true;
-        currentTime = ofClamp(currentTime, getInTimeInSeconds(), getOutTimeInSeconds());
-        playbackStartTime = timer.getAppTimeSeconds() - currentTime;
-        playbackStartFrame = ofGetFrameNum() - timecode.frameForSeconds(currentTime);
+        currentTimeMicros = MAX(currentTimeMicros, (long long)getInTimeInMicros());
+        currentTimeMicros = MIN(currentTimeMicros, (long long)getOutTimeInMicros());
+        syncPlaybackStart();
 		ofxTLPlaybackEventArgs args = createPlaybackEvent();
 		ofNotifyEvent(timelineEvents.playbackStarted, args);
+		wakeThread();
 	}
 }
 
@@ -552,6 +1052,7 @@ void ofxTimeline::stop(){
 		}
 
         isPlaying = false;
+        wakeThread();
 
 		if(!ticker->getIsScrubbing()){ //dont trigger event if we are just scrubbing
 			ofxTLPlaybackEventArgs args = createPlaybackEvent();
@@ -562,14 +1063,17 @@ void ofxTimeline::stop(){
 
 void ofxTimeline::playSelectedTrack(){
 	if(currentPage->getFocusedTrack() != NULL) currentPage->getFocusedTrack()->play();
+	wakeThread();
 }
 
 void ofxTimeline::stopSelectedTrack(){
 	if(currentPage->getFocusedTrack() != NULL) currentPage->getFocusedTrack()->stop();
+	wakeThread();
 }
 
 bool ofxTimeline::togglePlaySelectedTrack(){
 	if(currentPage->getFocusedTrack() != NULL) currentPage->getFocusedTrack()->togglePlay();
+	wakeThread();
 	return getIsPlaying();
 }
 
@@ -617,24 +1121,55 @@ void ofxTimeline::setCurrentTimecode(string timecodeString){
 }
 
 void ofxTimeline::setCurrentTimeSeconds(float time){
-	currentTime = time;
+	currentTimeMicros = time * 1000000.0;
     if(isPlaying){
-        playbackStartTime = timer.getAppTimeSeconds() - currentTime;
-        playbackStartFrame = ofGetFrameNum() - timecode.frameForSeconds(currentTime);
+        syncPlaybackStart();
     }
- 
+    wakeThread();
 }
 
 void ofxTimeline::setCurrentTimeMillis(unsigned long long millis){
-	setCurrentTimeSeconds(millis/1000.);
+	setCurrentTimeMicros(millis*1000);
+}
+
+void ofxTimeline::setCurrentTimeMicros(unsigned long long micros){
+	currentTimeMicros = micros;
+    if(isPlaying){
+        syncPlaybackStart();
+    }
+    wakeThread();
+}
+
+void ofxTimeline::syncPlaybackStart(){
+    syncPlaybackStart(getClockMicros());
+}
+
+void ofxTimeline::syncPlaybackStart(long long nowMicros){
+    playbackStartMicros = nowMicros - currentTimeMicros;
+    playbackStartFrame = ofGetFrameNum() - timecode.frameForMicros(getCurrentTimeMicros());
+}
+
+//freezes the playhead where it was at nowMicros instead of wherever the last update left it
+void ofxTimeline::stopAt(long long nowMicros){
+    if(isPlaying && timeControl == NULL && !isFrameBased){
+        currentTimeMicros = nowMicros - playbackStartMicros;
+        currentTimeMicros = MAX(currentTimeMicros, (long long)getInTimeInMicros());
+        currentTimeMicros = MIN(currentTimeMicros, (long long)getOutTimeInMicros());
+    }
+    stop();
 }
 
 void ofxTimeline::setFrameRate(float fps){
 	timecode.setFPS(fps);
 }
 
+void ofxTimeline::setFrameRate(int numerator, int denominator){
+	timecode.setFPS(numerator, denominator);
+}
+
 void ofxTimeline::setFrameBased(bool frameBased){
     isFrameBased = frameBased;
+    wakeThread();
 }
 
 bool ofxTimeline::getIsFrameBased(){
@@ -642,7 +1177,7 @@ bool ofxTimeline::getIsFrameBased(){
 }
 
 int ofxTimeline::getCurrentFrame(){
-    return timecode.frameForSeconds(currentTime);
+    return timecode.frameForMicros(getCurrentTimeMicros());
 }
 
 int ofxTimeline::getCurrentPageIndex() {
@@ -654,31 +1189,38 @@ string ofxTimeline::getCurrentPageName() {
 }
 
 long ofxTimeline::getCurrentTimeMillis(){
-    return currentTime*1000;
+    return currentTimeMicros/1000;
+}
+
+unsigned long long ofxTimeline::getCurrentTimeMicros(){
+    return MAX(currentTimeMicros, 0LL);
 }
 
 float ofxTimeline::getCurrentTime(){
-	return currentTime;
+	return currentTimeMicros/1000000.0;
 }
 
 float ofxTimeline::getPercentComplete(){
-    return currentTime / durationInSeconds;
+    return currentTimeMicros / (durationInSeconds*1000000.0);
 }
 
 string ofxTimeline::getCurrentTimecode(){
-    return timecode.timecodeForSeconds(currentTime);
+    return timecode.timecodeForMillis(getCurrentTimeMicros()/1000);
 }
 
 long ofxTimeline::getQuantizedTime(unsigned long long time, unsigned long long step){
-	double oneMeasure = 1000/(getBPM()/240.); // in milliseconds
+	//measures count from the start of the tempo the time falls in
+	unsigned long long tempoStart = ticker->getTempoStartMillis(time);
+	double oneMeasure = 1000/(ticker->getBPMAtMillis(time)/240.); // in milliseconds
 	step = oneMeasure / step; // convert step to milliseconds
+	time -= tempoStart;
 	unsigned long long base = time / step;
 	base = time % step > (step * 0.5) ? base + 1 : base; // round up or down
-	return base * step;
+	return tempoStart + base * step;
 }
 
 void ofxTimeline::setInPointAtPlayhead(){
-    setInPointAtSeconds(currentTime);
+    setInPointAtSeconds(getCurrentTime());
 }
 void ofxTimeline::setInPointAtPercent(float percent){
 	inoutRange.min = ofClamp(percent, 0, inoutRange.max);
@@ -698,7 +1240,7 @@ void ofxTimeline::setInPointAtTimecode(string timecodeString){
 }
 
 void ofxTimeline::setOutPointAtPlayhead(){
-    setOutPointAtSeconds(currentTime);
+    setOutPointAtSeconds(getCurrentTime());
 }
 void ofxTimeline::setOutPointAtPercent(float percent){
 	inoutRange.max = ofClamp(percent, inoutRange.min, 1.0);
@@ -734,6 +1276,7 @@ void ofxTimeline::triggerInOutEvent(){
     args.sender = this;
     args.inoutRange = inoutRange;
     ofNotifyEvent(events().inOutChanged, args);
+    wakeThread();
 }
 
 void ofxTimeline::setCurrentTimeToInPoint(){
@@ -776,6 +1319,10 @@ long ofxTimeline::getInTimeInMillis(){
     return getInTimeInSeconds()*1000;
 }
 
+unsigned long long ofxTimeline::getInTimeInMicros(){
+    return double(durationInSeconds) * inoutRange.min * 1000000.0;
+}
+
 string ofxTimeline::getInPointTimecode(){
 	return timecode.timecodeForSeconds(getInTimeInSeconds());
 }
@@ -784,6 +1331,10 @@ long ofxTimeline::getOutTimeInMillis(){
     return getOutTimeInSeconds()*1000;
 }
 
+unsigned long long ofxTimeline::getOutTimeInMicros(){
+    return double(durationInSeconds) * inoutRange.max * 1000000.0;
+}
+
 string ofxTimeline::getOutPointTimecode(){
 	return timecode.timecodeForSeconds(getOutTimeInSeconds());
 }
@@ -801,7 +1352,10 @@ bool ofxTimeline::toggleEnabled(){
 void ofxTimeline::enable(){
     if(!isEnabled){
 		isEnabled = true;
-		enableEvents();
+		//no mouse or keys to listen to
+		if(!isHeadless){
+			enableEvents();
+		}
     }
 }
 
@@ -831,14 +1385,19 @@ void ofxTimeline::reset(){ //gets rid of everything
         return;
     }
 
-
+	waitForLoad();
+	autosaver.flush();
+	closeJournal();
 
 	if(isOnThread){
-		waitForThread(true);
+		//a stopped timeline's thread sleeps until it's woken
+		stopThread();
+		wakeThread();
+		waitForThread(false);
 	}
 
     disable();
-    undoStack.clear();
+    clearUndoHistory();
     for(int i = 0; i < pages.size(); i++){
         delete pages[i];
     }
@@ -892,6 +1451,7 @@ void ofxTimeline::setDurationInSeconds(float seconds){
 	}
 
 	zoomer->setViewRange(zoomer->getSelectedRange());
+	wakeThread();
 }
 
 void ofxTimeline::setDurationInMillis(unsigned long long millis){
@@ -928,6 +1488,40 @@ void ofxTimeline::setAutosave(bool doAutosave){
 	autosave = doAutosave;
 }
 
+void ofxTimeline::setAutosaveDelay(int millis){
+	autosaver.setDelay(millis);
+}
+
+int ofxTimeline::getAutosaveDelay(){
+	return autosaver.getDelay();
+}
+
+void ofxTimeline::flushAutosave(){
+	autosaver.flush();
+}
+
+void ofxTimeline::setUseJournal(bool journalOn){
+	if(!journalOn){
+		closeJournal();
+	}
+	else if(!useJournal){
+		recoverJournal();
+	}
+	useJournal = journalOn;
+}
+
+bool ofxTimeline::getUseJournal(){
+	return useJournal;
+}
+
+void ofxTimeline::setJournalCompactSize(unsigned long long bytes){
+	journalCompactSize = bytes;
+}
+
+string ofxTimeline::getJournalPath(){
+	return ofToDataPath(workingFolder + name + "_journal.bin");
+}
+
 void ofxTimeline::setOffset(ofVec2f newOffset){
     if(offset != newOffset){
         offset = newOffset;
@@ -938,8 +1532,8 @@ void ofxTimeline::setOffset(ofVec2f newOffset){
 }
 
 void ofxTimeline::setLockWidthToWindow(bool lockWidth){
-    lockWidthToWindow = lockWidth;
-    if(width != ofGetWidth()){
+    lockWidthToWindow = lockWidth && !isHeadless;
+    if(!isHeadless && width != ofGetWidth()){
         recalculateBoundingRects();
     }
 }
@@ -989,7 +1583,7 @@ bool ofxTimeline::getLockWidthToWindow(){
 
 void ofxTimeline::setWidth(float newWidth){
     if(width != newWidth){
-		if(newWidth != ofGetWidth()){
+		if(isHeadless || newWidth != ofGetWidth()){
 			lockWidthToWindow = false;
 		}
         width = newWidth;
@@ -1076,6 +1670,14 @@ float ofxTimeline::getBPM() {
 	return ticker->getBPM();
 }
 
+void ofxTimeline::addTempoChange(unsigned long long millis, float bpm){
+	ticker->addTempoChange(millis, bpm);
+}
+
+void ofxTimeline::clearTempoChanges(){
+	ticker->clearTempoChanges();
+}
+
 bool ofxTimeline::toggleSnapToBPM(){
 	snapToBPM = !snapToBPM;
     return snapToBPM;
@@ -1330,18 +1932,18 @@ void ofxTimeline::keyPressed(ofKeyEventArgs& args){
 			if(getTotalSelectedItems() == 0){
 				if(args.key == OF_KEY_LEFT){
 					if(getIsFrameBased()){
-						currentTime -= timecode.secondsForFrame(1);
+						currentTimeMicros -= timecode.microsForFrame(1);
 					}
 					else{
-						currentTime -= nudgeAmount.x*getDurationInSeconds();
+						currentTimeMicros -= nudgeAmount.x*getDurationInSeconds()*1000000.0;
 					}
 				}
 				if(args.key == OF_KEY_RIGHT){
 					if(getIsFrameBased()){
-						currentTime += timecode.secondsForFrame(1);
+						currentTimeMicros += timecode.microsForFrame(1);
 					}
 					else{
-						currentTime += nudgeAmount.x*getDurationInSeconds();
+						currentTimeMicros += nudgeAmount.x*getDurationInSeconds()*1000000.0;
 					}
 				}
 			}
@@ -1395,7 +1997,9 @@ void ofxTimeline::exit(ofEventArgs& args){
 //
 	if(isOnThread){
 		ofLogNotice("ofxTimeline::exit") << "waiting for thread" << endl;
-		waitForThread(true);
+		stopThread();
+		wakeThread();
+		waitForThread(false);
 	}
 
 }
@@ -1436,6 +2040,9 @@ void ofxTimeline::pageChanged(ofxTLPageEventArgs& args){
 				currentPage->unselectAll();
 			}
 			currentPage = pages[i];
+			if(lazyPageLoading){
+				currentPage->loadEditorData();
+			}
 			ofEventArgs args;
 			ofNotifyEvent(events().viewWasResized, args);
 			return;
@@ -1447,6 +2054,7 @@ void ofxTimeline::pageChanged(ofxTLPageEventArgs& args){
 
 void ofxTimeline::setLoopType(ofLoopType newType){
 	loopType = newType;
+	wakeThread();
 }
 
 ofLoopType ofxTimeline::getLoopType(){
@@ -1461,12 +2069,33 @@ void ofxTimeline::update(ofEventArgs& updateArgs){
 	if(!isOnThread){
 		updateTime();
 	}
+	else if(isFrameBased && getIsPlaying()){
+		wakeThread();
+	}
+	autosaver.collectFinished();
+	updateLoad();
 }
 
 void ofxTimeline::threadedFunction(){
 	while(isThreadRunning()){
 		updateTime();
-		ofSleepMillis(1);
+
+		//worked out before locking so wakeThread() callers never wait on the tracks,
+		//a wake that comes in between is still seen through threadWakeRequested
+		long long wakeMicros = getNextWakeMicros();
+		std::unique_lock<std::mutex> lock(threadWakeLock);
+		if(!threadWakeRequested && isThreadRunning()){
+			if(wakeMicros < 0){
+				threadWakeCondition.wait(lock, [this]{ return threadWakeRequested; });
+			}
+			else{
+				long long sleepMicros = wakeMicros - getClockMicros();
+				if(sleepMicros > 0){
+					threadWakeCondition.wait_for(lock, std::chrono::microseconds(sleepMicros), [this]{ return threadWakeRequested; });
+				}
+			}
+		}
+		threadWakeRequested = false;
 	}
 }
 
@@ -1475,10 +2104,10 @@ void ofxTimeline::updateTime(){
 	if(getIsPlaying()){
 		if(timeControl == NULL){
 			if(isFrameBased){
-				currentTime = timecode.secondsForFrame(ofGetFrameNum() - playbackStartFrame);
+				currentTimeMicros = timecode.microsForFrame(ofGetFrameNum() - playbackStartFrame);
 			}
 			else {
-				currentTime = timer.getAppTimeSeconds() - playbackStartTime;
+				currentTimeMicros = getClockMicros() - playbackStartMicros;
 			}
 			checkLoop();
 		}
@@ -1494,21 +2123,23 @@ void ofxTimeline::checkEvents(){
 }
 
 void ofxTimeline::checkLoop(){
-	if(currentTime < durationInSeconds*inoutRange.min){
-        currentTime = durationInSeconds*inoutRange.min;
-        playbackStartTime = timer.getAppTimeSeconds() - currentTime;
-        playbackStartFrame = ofGetFrameNum() - timecode.frameForSeconds(currentTime);
+	long long inMicros = getInTimeInMicros();
+	long long outMicros = getOutTimeInMicros();
+	if(currentTimeMicros < inMicros){
+        currentTimeMicros = inMicros;
+        syncPlaybackStart();
     }
 
-    if(currentTime >= durationInSeconds*inoutRange.max){
+    if(currentTimeMicros >= outMicros){
         if(loopType == OF_LOOP_NONE){
-            currentTime = durationInSeconds*inoutRange.max;
+            currentTimeMicros = outMicros;
             stop();
         }
         else if(loopType == OF_LOOP_NORMAL) {
-            currentTime = durationInSeconds*inoutRange.min + (currentTime - durationInSeconds*inoutRange.max);
+            //shift the start by exactly one loop so the integer clock never accumulates error
+            currentTimeMicros = inMicros + (currentTimeMicros - outMicros);
             playbackStartFrame += getDurationInFrames()  * inoutRange.span();
-            playbackStartTime  += getDurationInSeconds() * inoutRange.span();
+            playbackStartMicros += outMicros - inMicros;
             ofxTLPlaybackEventArgs args = createPlaybackEvent();
             ofNotifyEvent(events().playbackLooped, args);
         }
@@ -1517,7 +2148,7 @@ void ofxTimeline::checkLoop(){
 
 void ofxTimeline::draw(){
 
-	if(isSetup && isShowing){
+	if(isSetup && isShowing && !isHeadless){
 		ofPushStyle();
 
 		glDisable(GL_DEPTH_TEST);
@@ -1736,6 +2367,11 @@ void ofxTimeline::addTrack(string trackName, ofxTLTrack* track){
     }
 	track->setTimeline( this );
 	track->setName( trackName );
+	ofxTLKeyframes* keyframeTrack = dynamic_cast<ofxTLKeyframes*>(track);
+	if(curvesUseBinary && keyframeTrack != NULL){
+		keyframeTrack->useBinarySave = true;
+		keyframeTrack->useMappedLoad = useMappedLoad || lazyPageLoading;
+	}
 	currentPage->addTrack(trackName, track);
 	trackNameToPage[trackName] = currentPage;
 	ofEventArgs args;
@@ -1764,7 +2400,6 @@ ofxTLCurves* ofxTimeline::addCurves(string trackName, ofRange valueRange, float
 
 ofxTLCurves* ofxTimeline::addCurves(string trackName, string xmlFileName, ofRange valueRange, float defaultValue){
 	ofxTLCurves* newCurves = new ofxTLCurves();
-	newCurves->useBinarySave = curvesUseBinary;
 	newCurves->setCreatedByTimeline(true);
 	newCurves->setValueRange(valueRange, defaultValue);
 	newCurves->setXMLFileName(xmlFileName);
@@ -2005,13 +2640,29 @@ void ofxTimeline::removeTrack(string name){
     //but to prevent crashes, let's just go through the undo queue and remove any items that have to do with this track
     for(int i = 0; i < undoStack.size(); i++){
         for(int q = undoStack[i].size()-1; q >= 0; q--){
-			if(undoStack[i][q].track == track){
+			if(undoStack[i][q]->getTrack() == track){
+                delete undoStack[i][q];
                 undoStack[i].erase(undoStack[i].begin() + q);
                 cout << "temporary fix -- deleting undo queue element for track " << track->getName() << endl;
             }
         }
     }
+    for(int i = stateBuffers.size()-1; i >= 0; i--){
+        if(stateBuffers[i]->getTrack() == track){
+            delete stateBuffers[i];
+            stateBuffers.erase(stateBuffers.begin() + i);
+        }
+    }
 
+	if(loader.isLoading(track)){
+		waitForLoad();
+	}
+	//the save job holds on to the track, a journal compaction could too
+	autosaver.cancel(track);
+	if(journal.isOpen()){
+		journaledTracks.erase(track);
+		autosaver.flush();
+	}
     trackNameToPage[name]->removeTrack(track);
     trackNameToPage.erase(name);
 	ofEventArgs args;
@@ -2031,9 +2682,17 @@ ofxTimecode& ofxTimeline::getTimecode(){
 }
 
 ofxMSATimer& ofxTimeline::getTimer(){
+	//timelines on a scheduler all read the same clock
+	if(scheduler != nullptr){
+		return scheduler->getTimer();
+	}
 	return timer;
 }
 
+long long ofxTimeline::getClockMicros(){
+	return getTimer().getAppTimeMicros();
+}
+
 vector<ofxTLPage*>& ofxTimeline::getPages(){
     return pages;
 }
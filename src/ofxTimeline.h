@@ -33,6 +33,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include <condition_variable>
 
 #ifndef OFX_TIMELINE_FONT_RENDERER
 #define OFX_TIMELINE_FONT_RENDERER ofTrueTypeFont
@@ -57,20 +58,30 @@
 #include "ofxTLColors.h"
 #include "ofxTLLFO.h"
 #include "ofxTLNotes.h"
+#include "ofxTLWorkerPool.h"
+#include "ofxTLScheduler.h"
+#include "ofxTLOfflineRenderer.h"
+#include "ofxTLExporter.h"
+#include "ofxTLJournal.h"
 
 
-typedef struct {
-    ofxTLTrack* track;
-    string stateBuffer;
-} UndoItem;
-
 class ofxTimeline : ofThread {
+	friend class ofxTLScheduler;
+	friend class ofxTLOfflineRenderer;
+	friend class ofxTLTrack;
   public:
 	
 	ofxTimeline();
 	virtual ~ofxTimeline();
 
 	virtual void setup();
+
+	//call before setup() to run without a window, GL context or fonts,
+	//e.g. on a render node or in CI. loading, sampling, events and saving
+	//work as usual but previews, textures and fonts are never touched
+	//and draw() does nothing
+	void setHeadless(bool headless);
+	bool getIsHeadless();
 	
 	//Optionally run ofxTimeline on the background thread
 	//this isn't necessary most of the time but
@@ -78,6 +89,32 @@ class ofxTimeline : ofThread {
 	//improve performance
 	virtual void moveToThread();
     virtual void removeFromThread();
+
+	//alternatively share one thread and one clock with other timelines,
+	//removeFromThread() takes it off the scheduler again
+	virtual void moveToScheduler(ofxTLScheduler* scheduler);
+	ofxTLScheduler* getScheduler();
+
+	//on the thread the timeline sleeps until the next bang, switch or note edge
+	//and wakes early on play, stop or seek. set a sample rate if your own
+	//tracks need update() called regularly too, 0 is events only
+	void setThreadSampleRate(float samplesPerSecond);
+	float getThreadSampleRate();
+
+	//update the tracks of a page side by side on a small pool of threads.
+	//bang and switch events are still sent one at a time, in track order,
+	//after every track has updated. only turn this on if your custom tracks'
+	//update() doesn't touch shared state
+	void setParallelUpdate(bool parallel, int numThreads = 0);
+	bool getParallelUpdate();
+	ofxTLWorkerPool& getWorkerPool();
+
+	//call counts and timings for every track, see ofxTLProfiler.h.
+	//empty unless the addon is built with OFXTL_PROFILE defined
+	vector<ofxTLTrackStats> getStats();
+	void resetStats();
+	//writes csv if the path ends in .csv, json otherwise
+	bool saveStats(string filePath);
 	
 	bool toggleEnabled();
     void enable();
@@ -140,12 +177,22 @@ class ofxTimeline : ofThread {
     //loads calls load on all tracks from the given folder
     //really useful for setting up 'project' directories
     void loadTracksFromFolder(string folderPath);
+	//same, but returns right away and reads the files on worker threads. tracks get
+	//their keys from update() as each one is read, see events().loadProgressed and loadFinished.
+	//tracks that can't be read off the main thread are loaded before this returns
+	void loadTracksFromFolderAsync(string folderPath, int numThreads = 0);
+	bool isLoading();
+	float getLoadProgress();
+	//blocks until the load is done, progress events still come from in here
+	void waitForLoad();
     void saveTracksToFolder(string folderPath);
 
     void setDefaultFontPath(string fontPath);
     
     //timing setup functions
     void setFrameRate(float fps);    
+    //exact rates like 30000/1001, turn on drop frame timecode through getTimecode()
+    void setFrameRate(int numerator, int denominator);
     void setDurationInFrames(int frames);
 	void setDurationInSeconds(float seconds);
 	void setDurationInMillis(unsigned long long millis);
@@ -164,7 +211,39 @@ class ofxTimeline : ofThread {
     //autosave will always write to XML file on each major change 
     //otherwise call save manually to write the files
     void setAutosave(bool autosave);
+	//autosaves of keyframe tracks are written on a background thread once the track
+	//has gone this long without another change, 250ms by default
+	void setAutosaveDelay(int millis);
+	int getAutosaveDelay();
+	//writes any autosaves that are still waiting and returns once they are on disk
+	void flushAutosave();
+	//with autosave and the journal on, keyframe tracks append just what changed to
+	//a log next to the track files instead of writing the whole track. the log is
+	//folded back into the track files in the background once it grows past the
+	//compact size, by save() and when the timeline is reset.
+	//turning it on replays whatever a crash left in the log, so add the tracks first.
+	//the log isn't synced to disk, it covers the app crashing but not a power cut
+	void setUseJournal(bool useJournal);
+	bool getUseJournal();
+	void setJournalCompactSize(unsigned long long bytes);
+	string getJournalPath();
+	//applies edits left in the journal to the loaded tracks and saves them,
+	//returns true if there was anything. done for you by setUseJournal and loadTracksFromFolder
+	bool recoverJournal();
 	virtual void save();
+	//save keyframe tracks in the binary format instead of xml.
+	//applies to tracks added afterwards, existing xml files are still read
+	void setUseBinarySave(bool useBinary);
+	bool getUseBinarySave();
+	//with binary saving on, map big binary tracks into memory instead of loading them.
+	//only curves, lfos and plain keyframe tracks support it, the rest load normally
+	void setUseMappedLoad(bool useMapped);
+	bool getUseMappedLoad();
+	//with binary saving on, map every track that can be mapped and only turn a page's
+	//tracks into editable keys when the page is shown. pages that are never looked at
+	//play straight from their files. applies to tracks added afterwards
+	void setLazyPageLoading(bool lazy);
+	bool getLazyPageLoading();
 	//if there have been changes without a save.
 	//if autosave is on this will always return false
 	bool hasUnsavedChanges();
@@ -172,6 +251,7 @@ class ofxTimeline : ofThread {
 	virtual void setCurrentFrame(int currentFrame);
 	virtual void setCurrentTimeSeconds(float time);
     virtual void setCurrentTimeMillis(unsigned long long millis);
+    virtual void setCurrentTimeMicros(unsigned long long micros);
 	virtual void setPercentComplete(float percent);
 	virtual void setCurrentTimecode(string timecodeString);
     
@@ -183,6 +263,7 @@ class ofxTimeline : ofThread {
     virtual string getCurrentPageName();
 	virtual float getCurrentTime();
 	virtual long getCurrentTimeMillis();
+	virtual unsigned long long getCurrentTimeMicros();
     virtual float getPercentComplete();
 	virtual string getCurrentTimecode();
 	virtual long getQuantizedTime(unsigned long long time, unsigned long long step);
@@ -230,11 +311,13 @@ class ofxTimeline : ofThread {
 	int getInFrame();
 	float getInTimeInSeconds();
 	long getInTimeInMillis();
+	unsigned long long getInTimeInMicros();
     string getInPointTimecode();
     
     int getOutFrame();
 	float getOutTimeInSeconds();
 	long getOutTimeInMillis();
+	unsigned long long getOutTimeInMicros();
     string getOutPointTimecode();
 
 	virtual void setOffset(ofVec2f offset);
@@ -256,6 +339,9 @@ class ofxTimeline : ofThread {
 	//this is useful for snapping to intervals
 	void setBPM(float bpm);
 	float getBPM();
+	//tempo changes part way through, the grid restarts on the beat at each one
+	void addTempoChange(unsigned long long millis, float bpm);
+	void clearTempoChanges();
 	
     bool toggleSnapToBPM();
     void enableSnapToBPM(bool enableSnap);
@@ -277,6 +363,15 @@ class ofxTimeline : ofThread {
     void enableUndo(bool enabled);
     void undo();
     void redo();
+    //oldest actions are dropped once the history goes over this many bytes. 0 means no limit
+    void setUndoMemoryBudget(size_t bytes);
+    size_t getUndoMemoryBudget();
+    //compress everything but the most recent few actions
+    void setUndoCompression(bool compress, int uncompressedActions = 10);
+    bool getUndoCompression();
+    //bytes currently held by the undo history
+    size_t getUndoMemoryUsage();
+    int getUndoStackSize();
     
 	void setMovePlayheadOnDrag(bool updatePlayhead);
 	bool getMovePlayheadOnDrag();
@@ -390,6 +485,8 @@ class ofxTimeline : ofThread {
 	ofxTLColors& getColors();
 	ofxTimecode& getTimecode();
 	ofxMSATimer& getTimer();
+	//what playback reads the time from, getTimer() unless a subclass supplies its own clock
+	virtual long long getClockMicros();
 	ofxTLZoomer* getZoomer();
 	
 	vector<ofxTLPage*>& getPages();
@@ -433,8 +530,10 @@ class ofxTimeline : ofThread {
     
     virtual ofxTLEvents& events();
     
-	//binary test hack
+	//see setUseBinarySave
 	bool curvesUseBinary;
+	bool useMappedLoad;
+	bool lazyPageLoading;
 
     bool forceRetina;
     int  retinaScale;
@@ -462,9 +561,24 @@ class ofxTimeline : ofThread {
     string workingFolder; 
     
 	bool isSetup;
+	bool isHeadless;
 	bool usingEvents;
 	bool isOnThread;
 
+	bool parallelUpdate;
+	ofxTLWorkerPool workerPool;
+
+	ofxTLScheduler* scheduler;
+
+	float threadSampleRate;
+	bool threadWakeRequested;
+	std::mutex threadWakeLock;
+	std::condition_variable threadWakeCondition;
+	void wakeThread();
+	//timer micros the thread should sleep until, -1 to sleep until woken.
+	//only reads playback state and is called without threadWakeLock held
+	long long getNextWakeMicros();
+
 	//called when the name changes to setup the inout track, zoomer, ticker etc
 	void setupStandardElements();
 	
@@ -476,18 +590,23 @@ class ofxTimeline : ofThread {
 	//one string per track
 	vector<string> pasteboard;
     
-    bool undoEnabled; //turn off undo if you don't need it, it'll take up a ton of memory
+    bool undoEnabled; //turn off undo if you don't need it
     void collectStateBuffers();
     void pushUndoStack();
-    void restoreToState(vector<UndoItem>& state);
-    
-    //this is populated on mouse-down or key-down with all items that could potentially be modified
-	vector<UndoItem> stateBuffers; 
+    void clearUndoHistory();
+    void trimUndoHistory();
+    size_t getUndoActionMemoryUsage(vector<ofxTLUndoDelta*>& action);
+    size_t undoMemoryBudget;
+    bool compressUndo;
+    int uncompressedUndoActions;
+    
+    //this is populated on mouse-down or key-down with a delta for each track that could potentially be modified
+	vector<ofxTLUndoDelta*> stateBuffers; 
     //then after the events are propagated all the modified tracks are collected here 
     std::set<ofxTLTrack*> modifiedTracks;
-    //finally, the state buffers for the tracks that were modified are pushed onto the stack say that state may be returned
-    deque< vector<UndoItem> > undoStack;
-    //the undo pointer points into the array and lets the user move through undo/redo actions
+    //finally, the deltas for the tracks that were modified are finished and pushed onto the stack as one action
+    deque< vector<ofxTLUndoDelta*> > undoStack;
+    //the number of actions on the stack that are currently applied. undo steps it back, redo forward
     int undoPointer;
     
 	bool movePlayheadOnDrag;
@@ -539,13 +658,34 @@ class ofxTimeline : ofThread {
 	bool isPlaying; //moves playhead along
 	bool userChangedValue; //did value change this frame;
     
-    //TODO: switch to millis!
-	float currentTime; 	
+    //playhead is kept in integer micros against the monotonic timer
+    //so precision doesn't fall off after the app has been running for hours
+	long long currentTimeMicros;
 	ofLoopType loopType;
 	int playbackStartFrame;
-	double playbackStartTime;	
+	long long playbackStartMicros; //timer micros that line up with time 0
+	void syncPlaybackStart(); //call whenever the playhead jumps while playing
+	void syncPlaybackStart(long long nowMicros);
+	void stopAt(long long nowMicros);
 
 	bool autosave;
+	ofxTLAutosaver autosaver;
+	bool useJournal;
+	ofxTLJournal journal;
+	std::set<ofxTLTrack*> journaledTracks; //tracks with edits in the log since the last compaction
+	unsigned long long journalCompactSize;
+	bool journalChanges(ofxTLTrack* track);
+
+	ofxTLLoader loader;
+	bool loadingTracks;
+	//finishes tracks that have been read and sends the events
+	void updateLoad();
+	void openJournal();
+	//the track files match memory, start the log over
+	void restartJournal();
+	void compactJournal();
+	//writes out what's in the log so nothing needs recovering, then closes it
+	void closeJournal();
 	bool unsavedChanges;
 	bool headersAreEditable;
 	bool minimalHeaders;